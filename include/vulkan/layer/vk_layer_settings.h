@@ -27,17 +27,160 @@ extern "C" {
 
 #include "vk_layer_settings_ext.h"
 
+// Called asynchronously for each message, by a background thread of the library after the call that logged the message returned,
+// so the callback must be thread-safe and must remain loaded until vlFlushLayerSettingsLog returns or the library is unloaded.
+// Once the library is unloading, the messages are delivered synchronously by the threads that log them. The repetitions of a
+// message are not delivered, their number is reported periodically, by vlFlushLayerSettingsLog and when the layer settings
+// which logged the message are destroyed.
 typedef void *(*VL_LAYER_SETTING_LOG_CALLBACK)(const char *pSettingName, const char *pMessage);
 
+// Wait until the messages logged before the call are delivered, for example before the library of a log callback is unloaded
+void vlFlushLayerSettingsLog(void);
+
+// Opaque handle to a setting resolved by vlInitLayerSettings. Handles are invalidated by the next vlInitLayerSettings call and
+// by hot reloads, see vlGetLayerSettingsGeneration. A handle identifies the layer settings it was returned by, so that a handle
+// invalidated by a reload is never resolved to another setting: the queries by handle report it as not found or return
+// VK_ERROR_INITIALIZATION_FAILED, and the handle must be found again.
+typedef uint64_t VlLayerSettingHandle;
+
+#define VL_NULL_LAYER_SETTING_HANDLE 0
+
 // Initialize the layer settings. If 'pCallback' is set to NULL, the messages are outputed to stderr.
+// The queries are thread-safe, including while another thread initializes the layer settings again.
 void vlInitLayerSettings(const char *pLayerName, const VkInstanceCreateInfo *pCreateInfo, VL_LAYER_SETTING_LOG_CALLBACK pCallback);
 
+// Same as vlInitLayerSettings, except that the layer settings are allocated with 'pAllocator', typically the allocator passed
+// to vkCreateInstance, or with the global heap if it is NULL. The callbacks are copied and called until the layer settings are
+// released, by vlDestroyLayerSettings, by the next initialization or at exit. Return VK_ERROR_OUT_OF_HOST_MEMORY if an
+// allocation fails, in which case the previous layer settings remain in place. The state shared by all the layer settings of
+// the process, such as the parse of vk_layer_settings.txt, and the snapshot of the environment variables are allocated with the
+// global heap.
+VkResult vlInitLayerSettings2(const char *pLayerName, const VkInstanceCreateInfo *pCreateInfo,
+                              const VkAllocationCallbacks *pAllocator, VL_LAYER_SETTING_LOG_CALLBACK pCallback);
+
+// Release the layer settings, typically from vkDestroyInstance so that the allocation callbacks given to vlInitLayerSettings2
+// are not called afterward. The hot reload stops until the next initialization. The queries must not run concurrently; they
+// report the settings as not set until the layer settings are initialized again.
+void vlDestroyLayerSettings(void);
+
+// Same as vlInitLayerSettings, except that the settings file is found and parsed on another thread and the function returns
+// immediately. The queries wait for the initialization to complete. The VK_EXT_layer_settings values of 'pCreateInfo' are copied
+// before the function returns, the application may free them afterward.
+void vlInitLayerSettingsAsync(const char *pLayerName, const VkInstanceCreateInfo *pCreateInfo,
+                              VL_LAYER_SETTING_LOG_CALLBACK pCallback);
+
+// Enable or disable the hot reload of the layer settings, disabled by default. While enabled, a thread watches the
+// vk_layer_settings.txt files that vlInitLayerSettings may find and initializes the layer settings again, with the same
+// VK_EXT_layer_settings values and environment variables, each time one of them changes. The settings file is found again by
+// each reload, so that a file created with a higher precedence is used. The VK_EXT_layer_settings values are copied by
+// vlInitLayerSettings, the application may free them once vkCreateInstance returned. The environment variables are read by
+// vlInitLayerSettings, their later changes apply at the next initialization. The queries are not blocked by a reload. Return
+// VK_ERROR_INITIALIZATION_FAILED if none of the files can be watched.
+VkResult vlSetLayerSettingsHotReload(VkBool32 enable);
+
+// Return a counter incremented each time new layer settings are published, by vlInitLayerSettings or by a hot reload. It is
+// cheap to poll, so that layers know when to refresh the handles and values they cached.
+uint64_t vlGetLayerSettingsGeneration(void);
+
+// Return the number of bytes allocated for the layer settings initialized by vlInitLayerSettings, 0 if they are not initialized.
+// The values of vk_layer_settings.txt, shared by the layer settings of all the layers and setting sets, are not counted.
+size_t vlGetLayerSettingsMemoryUsage(void);
+
 // Check whether a setting was set either programmatically, from vk_layer_settings.txt or an environment variable
 VkBool32 vlHasLayerSetting(const char *pSettingName);
 
-// Query setting values
+// Query setting values. The queries returning a VkResult return VK_ERROR_OUT_OF_HOST_MEMORY if an allocation fails.
 VkResult vlGetLayerSettingValues(const char *pSettingName, VkLayerSettingTypeEXT type, uint32_t *pValueCount, void *pValues);
 
+// Find a setting once to query its values by handle afterward. Return VL_NULL_LAYER_SETTING_HANDLE if the setting is not set
+VlLayerSettingHandle vlGetLayerSettingHandle(const char *pSettingName);
+
+// Query setting values using a handle returned by vlGetLayerSettingHandle. Return VK_ERROR_INITIALIZATION_FAILED if the handle
+// was returned by previous layer settings. The first query of each type converts the values under a lock, the later queries
+// don't lock.
+VkResult vlGetLayerSettingValuesByHandle(VlLayerSettingHandle handle, VkLayerSettingTypeEXT type, uint32_t *pValueCount,
+                                         void *pValues);
+
+// Check whether 'frame' is selected by the VK_LAYER_SETTING_TYPE_FRAMESET_EXT values of a setting. The values are compiled by
+// the first call into a bitmap of the first 65536 frames, queried in constant time. Later frames take a binary search over the
+// framesets with a step of 1, then a binary search for each distinct larger step.
+VkBool32 vlIsFrameInLayerSettingFrameset(VlLayerSettingHandle handle, uint32_t frame);
+
+// Check whether 'pValue' is one of the VK_LAYER_SETTING_TYPE_STRING_EXT values of a setting, for example a message ID in a
+// filter list. The values are hashed by the first call so that later calls take constant time, whatever the number of values.
+VkBool32 vlLayerSettingContains(VlLayerSettingHandle handle, const char *pValue);
+
+// Layer settings resolved for one instance, independent of the layer settings initialized by vlInitLayerSettings
+typedef struct VlLayerSettingSet_T *VlLayerSettingSet;
+
+// Resolve the layer settings of an instance. Setting sets can be created concurrently. The vk_layer_settings.txt values are
+// parsed once and shared by the setting sets of a layer while the file is unchanged, the snapshot of the environment variables
+// is shared by all the setting sets and layer settings while the environment is unchanged.
+// The setting set is allocated with 'pAllocator' as with vlInitLayerSettings, until it is destroyed. Return
+// VK_ERROR_OUT_OF_HOST_MEMORY if an allocation fails.
+VkResult vlCreateLayerSettingSet(const char *pLayerName, const VkInstanceCreateInfo *pCreateInfo,
+                                 const VkAllocationCallbacks *pAllocator, VL_LAYER_SETTING_LOG_CALLBACK pCallback,
+                                 VlLayerSettingSet *pLayerSettingSet);
+
+// Destroy a setting set, with the allocation callbacks it was created with. The setting set must not be queried concurrently.
+void vlDestroyLayerSettingSet(VlLayerSettingSet layerSettingSet);
+
+// Same as vlGetLayerSettingsMemoryUsage for a setting set
+size_t vlGetLayerSettingSetMemoryUsage(VlLayerSettingSet layerSettingSet);
+
+// Same as vlHasLayerSetting, vlGetLayerSettingValues, vlGetLayerSettingHandle and vlGetLayerSettingValuesByHandle for the settings
+// of a setting set. Handles are specific to the setting set they are returned by, the handles of another setting set are rejected
+// as handles of previous layer settings.
+VkBool32 vlHasLayerSettingInSet(VlLayerSettingSet layerSettingSet, const char *pSettingName);
+
+VkResult vlGetLayerSettingSetValues(VlLayerSettingSet layerSettingSet, const char *pSettingName, VkLayerSettingTypeEXT type,
+                                    uint32_t *pValueCount, void *pValues);
+
+VlLayerSettingHandle vlGetLayerSettingSetHandle(VlLayerSettingSet layerSettingSet, const char *pSettingName);
+
+VkResult vlGetLayerSettingSetValuesByHandle(VlLayerSettingSet layerSettingSet, VlLayerSettingHandle handle,
+                                            VkLayerSettingTypeEXT type, uint32_t *pValueCount, void *pValues);
+
+// One query of vlGetLayerSettingValuesBatch. 'valueCount' is set to the number of values of the setting and 'result' to the
+// result vlGetLayerSettingValues would return. Up to 'capacity' values are copied to 'pValues' if it is not NULL.
+typedef struct VlLayerSettingValuesQuery {
+    const char *pSettingName;
+    VkLayerSettingTypeEXT type;
+    uint32_t capacity;
+    void *pValues;
+    uint32_t valueCount;
+    VkResult result;
+} VlLayerSettingValuesQuery;
+
+// Name of a flag and the bits it sets in the mask of a setting
+typedef struct VlLayerSettingFlagInfo {
+    const char *pName;
+    uint64_t mask;
+} VlLayerSettingFlagInfo;
+
+// Register the flag names of a setting which values are a list of flags, for example "error,warn". The values are resolved into
+// a mask by each vlInitLayerSettings call, or immediately if the layer settings are already initialized, and by each
+// vlCreateLayerSettingSet call. 'pFlags' is copied. Registering no flags removes the registration of the setting.
+void vlRegisterLayerSettingFlags(const char *pSettingName, uint32_t flagCount, const VlLayerSettingFlagInfo *pFlags);
+
+// Return the mask of the flags of a setting registered by vlRegisterLayerSettingFlags, 0 if the setting is not set
+uint64_t vlGetLayerSettingFlags(VlLayerSettingHandle handle);
+
+// Query the values of many settings at once, filling the count and the values of each query in a single call. Return the first
+// error of the queries, otherwise VK_INCOMPLETE if the values of a query didn't fit its capacity, otherwise VK_SUCCESS.
+VkResult vlGetLayerSettingValuesBatch(uint32_t queryCount, VlLayerSettingValuesQuery *pQueries);
+
+// Same as vlIsFrameInLayerSettingFrameset, vlLayerSettingContains, vlGetLayerSettingFlags and vlGetLayerSettingValuesBatch for the
+// settings of a setting set. The flags are those registered when the setting set was created.
+VkBool32 vlIsFrameInLayerSettingSetFrameset(VlLayerSettingSet layerSettingSet, VlLayerSettingHandle handle, uint32_t frame);
+
+VkBool32 vlLayerSettingSetContains(VlLayerSettingSet layerSettingSet, VlLayerSettingHandle handle, const char *pValue);
+
+uint64_t vlGetLayerSettingSetFlags(VlLayerSettingSet layerSettingSet, VlLayerSettingHandle handle);
+
+VkResult vlGetLayerSettingSetValuesBatch(VlLayerSettingSet layerSettingSet, uint32_t queryCount,
+                                         VlLayerSettingValuesQuery *pQueries);
+
 #ifdef __cplusplus
 }
 #endif
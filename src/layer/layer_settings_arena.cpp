@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include "layer_settings_arena.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+namespace vl {
+
+// Blocks are aligned for any type, the allocations start after the header
+static const std::size_t BLOCK_HEADER_SIZE =
+    (sizeof(void *) + sizeof(std::size_t) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+const std::size_t Arena::MIN_BLOCK_SIZE;
+const std::size_t Arena::MAX_BLOCK_SIZE;
+
+void *AllocateMemory(const VkAllocationCallbacks *pAllocator, std::size_t size) {
+    if (pAllocator == nullptr) {
+        return ::operator new(size);
+    }
+
+    void *memory =
+        pAllocator->pfnAllocation(pAllocator->pUserData, size, alignof(std::max_align_t), VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void FreeMemory(const VkAllocationCallbacks *pAllocator, void *pMemory) {
+    if (pAllocator == nullptr) {
+        ::operator delete(pMemory);
+    } else {
+        pAllocator->pfnFree(pAllocator->pUserData, pMemory);
+    }
+}
+
+Arena::Arena(const VkAllocationCallbacks *pAllocator) {
+    if (pAllocator != nullptr) {
+        this->allocator = *pAllocator;
+        this->has_allocator = true;
+    }
+}
+
+Arena::~Arena() {
+    Block *block = this->blocks;
+    while (block != nullptr) {
+        Block *next = block->next;
+        FreeMemory(this->GetAllocator(), block);
+        block = next;
+    }
+}
+
+Arena::Block *Arena::AllocateBlock(std::size_t size) {
+    Block *block = static_cast<Block *>(AllocateMemory(this->GetAllocator(), size));
+    block->size = size;
+    this->size += size;
+    return block;
+}
+
+void *Arena::Allocate(std::size_t size, std::size_t alignment) {
+    assert(alignment != 0 && (alignment & (alignment - 1)) == 0 && alignment <= alignof(std::max_align_t));
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    this->used_size += size;
+
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(this->cursor);
+    char *aligned = this->cursor + (((address + alignment - 1) & ~(alignment - 1)) - address);
+    if (this->cursor != nullptr && size <= static_cast<std::size_t>(this->end - aligned)) {
+        this->cursor = aligned + size;
+        return aligned;
+    }
+
+    if (size > MAX_BLOCK_SIZE - BLOCK_HEADER_SIZE) {
+        // A large allocation gets its own block, inserted after the current block which remains in use
+        Block *block = this->AllocateBlock(BLOCK_HEADER_SIZE + size);
+        if (this->blocks == nullptr) {
+            block->next = nullptr;
+            this->blocks = block;
+        } else {
+            block->next = this->blocks->next;
+            this->blocks->next = block;
+        }
+        return reinterpret_cast<char *>(block) + BLOCK_HEADER_SIZE;
+    }
+
+    std::size_t block_size = this->next_block_size;
+    while (block_size - BLOCK_HEADER_SIZE < size) block_size *= 2;
+    this->next_block_size = block_size < MAX_BLOCK_SIZE ? block_size * 2 : MAX_BLOCK_SIZE;
+
+    Block *block = this->AllocateBlock(block_size);
+    block->next = this->blocks;
+    this->blocks = block;
+
+    char *data = reinterpret_cast<char *>(block) + BLOCK_HEADER_SIZE;
+    this->cursor = data + size;
+    this->end = reinterpret_cast<char *>(block) + block_size;
+    return data;
+}
+
+std::string_view Arena::CopyString(std::string_view s) {
+    char *data = static_cast<char *>(this->Allocate(s.size() + 1, 1));
+    if (!s.empty()) {
+        std::memcpy(data, s.data(), s.size());
+    }
+    data[s.size()] = '\0';
+    return std::string_view(data, s.size());
+}
+
+std::size_t Arena::GetSize() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->size;
+}
+
+std::size_t Arena::GetUsedSize() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->used_size;
+}
+
+}  // namespace vl
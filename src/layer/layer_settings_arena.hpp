@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#pragma once
+
+#include "vulkan/layer/vk_layer_settings.h"
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vl {
+    // Return memory from 'pAllocator' with the VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE scope, or from the global heap when it is
+    // nullptr. Throw std::bad_alloc on failure. The memory is aligned for any type.
+    void *AllocateMemory(const VkAllocationCallbacks *pAllocator, std::size_t size);
+    void FreeMemory(const VkAllocationCallbacks *pAllocator, void *pMemory);
+
+    // Bump allocator of the storage of a LayerSettings: allocations are carved out of large blocks and are only freed all at
+    // once, when the arena is destroyed. The blocks are allocated with the allocation callbacks of the arena. Thread-safe.
+    class Arena {
+      public:
+        // 'pAllocator' is copied, the callbacks must remain valid for the lifetime of the arena
+        explicit Arena(const VkAllocationCallbacks *pAllocator = nullptr);
+        ~Arena();
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        // Throw std::bad_alloc when a block can't be allocated. 'alignment' is at most alignof(std::max_align_t).
+        void *Allocate(std::size_t size, std::size_t alignment);
+
+        // Return a null terminated copy of 's'
+        std::string_view CopyString(std::string_view s);
+
+        template <typename T, typename... Args>
+        T *New(Args &&...args) {
+            return new (this->Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        // Return nullptr when the arena uses the global heap
+        const VkAllocationCallbacks *GetAllocator() const { return this->has_allocator ? &this->allocator : nullptr; }
+
+        // Bytes of the blocks allocated by the arena
+        std::size_t GetSize() const;
+
+        // Bytes of the allocations, not counting the alignment padding and the unused end of the blocks
+        std::size_t GetUsedSize() const;
+
+        // Size of the first block, the next blocks are twice as large up to MAX_BLOCK_SIZE
+        static const std::size_t MIN_BLOCK_SIZE = 4096;
+        static const std::size_t MAX_BLOCK_SIZE = 65536;
+
+      private:
+        struct Block {
+            Block *next;
+            std::size_t size;  // Including this header
+        };
+
+        Block *AllocateBlock(std::size_t size);
+
+        VkAllocationCallbacks allocator{};
+        bool has_allocator{false};
+
+        mutable std::mutex mutex;
+        Block *blocks{nullptr};
+        char *cursor{nullptr};
+        char *end{nullptr};
+        std::size_t next_block_size{MIN_BLOCK_SIZE};
+        std::size_t size{0};
+        std::size_t used_size{0};
+    };
+
+    // Standard allocator of the containers which storage is in an Arena. Deallocation is a no-op: the memory of a container
+    // which grows is only reclaimed with the arena, so the containers are reserved upfront when their size is known.
+    // Without an arena, the global heap is used, for example by the containers of the classes also used on their own.
+    template <typename T>
+    class ArenaAllocator {
+      public:
+        using value_type = T;
+
+        ArenaAllocator() = default;
+        ArenaAllocator(Arena &arena) : arena(&arena) {}
+        ArenaAllocator(Arena *arena) : arena(arena) {}
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.GetArena()) {}
+
+        T *allocate(std::size_t count) {
+            if (count > static_cast<std::size_t>(-1) / sizeof(T)) {
+                throw std::bad_array_new_length();
+            }
+            if (this->arena == nullptr) {
+                return static_cast<T *>(::operator new(count * sizeof(T)));
+            }
+            return static_cast<T *>(this->arena->Allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *pointer, std::size_t) {
+            if (this->arena == nullptr) {
+                ::operator delete(pointer);
+            }
+        }
+
+        Arena *GetArena() const { return this->arena; }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U> &other) const {
+            return this->arena == other.GetArena();
+        }
+
+        template <typename U>
+        bool operator!=(const ArenaAllocator<U> &other) const {
+            return this->arena != other.GetArena();
+        }
+
+      private:
+        Arena *arena{nullptr};
+    };
+
+    template <typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+    template <typename T>
+    using ArenaDeque = std::deque<T, ArenaAllocator<T>>;
+
+    using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+    template <typename Key, typename Value>
+    using ArenaMap = std::map<Key, Value, std::less<Key>, ArenaAllocator<std::pair<const Key, Value>>>;
+
+    template <typename Key, typename Value, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>>
+    using ArenaUnorderedMap = std::unordered_map<Key, Value, Hash, Equal, ArenaAllocator<std::pair<const Key, Value>>>;
+
+    // Deleter of the objects created by Arena::New, which memory is freed with the arena
+    struct ArenaDelete {
+        template <typename T>
+        void operator()(T *object) const {
+            object->~T();
+        }
+    };
+
+    template <typename T>
+    using ArenaPtr = std::unique_ptr<T, ArenaDelete>;
+} // namespace vl
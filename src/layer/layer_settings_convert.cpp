@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include "layer_settings_convert.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <system_error>
+
+// Floating-point std::from_chars is missing from older standard libraries
+#if !defined(__cpp_lib_to_chars)
+#include <locale>
+#include <sstream>
+#include <string>
+#endif
+
+namespace vl {
+
+static bool EqualsNoCase(std::string_view token, std::string_view lower_case) {
+    if (token.size() != lower_case.size()) {
+        return false;
+    }
+
+    for (std::size_t i = 0, n = token.size(); i < n; ++i) {
+        const char c = (token[i] >= 'A' && token[i] <= 'Z') ? static_cast<char>(token[i] - 'A' + 'a') : token[i];
+        if (c != lower_case[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Parse the magnitude of an integer, with an optional sign and "0x" prefix
+static ConvertResult ConvertMagnitude(std::string_view token, bool &negative, uint64_t &magnitude) {
+    std::size_t i = 0;
+
+    negative = !token.empty() && token[0] == '-';
+    if (negative) {
+        ++i;
+    }
+
+    int base = 10;
+    if (token.size() - i > 2 && token[i] == '0' && (token[i + 1] == 'x' || token[i + 1] == 'X')) {
+        base = 16;
+        i += 2;
+    }
+
+    // std::from_chars accepts a '-' sign that must not follow the prefix
+    if (i == token.size() || token[i] == '-') {
+        return CONVERT_ERROR_INVALID;
+    }
+
+    const char *last = token.data() + token.size();
+    const std::from_chars_result result = std::from_chars(token.data() + i, last, magnitude, base);
+
+    if (result.ec == std::errc::result_out_of_range) {
+        return CONVERT_ERROR_OUT_OF_RANGE;
+    }
+    if (result.ec != std::errc() || result.ptr != last) {
+        return CONVERT_ERROR_INVALID;
+    }
+
+    return CONVERT_SUCCESS;
+}
+
+template <typename T>
+static ConvertResult ConvertSigned(std::string_view token, T &value) {
+    bool negative = false;
+    uint64_t magnitude = 0;
+
+    const ConvertResult result = ConvertMagnitude(token, negative, magnitude);
+    if (result != CONVERT_SUCCESS) {
+        return result;
+    }
+
+    const uint64_t max = static_cast<uint64_t>(std::numeric_limits<T>::max());
+    if (magnitude > (negative ? max + 1 : max)) {
+        return CONVERT_ERROR_OUT_OF_RANGE;
+    }
+
+    value = negative ? static_cast<T>(0 - magnitude) : static_cast<T>(magnitude);
+    return CONVERT_SUCCESS;
+}
+
+template <typename T>
+static ConvertResult ConvertUnsigned(std::string_view token, T &value) {
+    bool negative = false;
+    uint64_t magnitude = 0;
+
+    const ConvertResult result = ConvertMagnitude(token, negative, magnitude);
+    if (result != CONVERT_SUCCESS) {
+        return result;
+    }
+
+    if ((negative && magnitude != 0) || magnitude > static_cast<uint64_t>(std::numeric_limits<T>::max())) {
+        return CONVERT_ERROR_OUT_OF_RANGE;
+    }
+
+    value = static_cast<T>(magnitude);
+    return CONVERT_SUCCESS;
+}
+
+// Match -?[0-9]*([.][0-9]*f?)? with at least one digit and remove the 'f' suffix of C and C++ literals. The infinity, NaN,
+// exponent and hexadecimal forms that std::from_chars and streams also accept are rejected.
+static bool IsDecimalFloat(std::string_view &token) {
+    std::size_t i = 0;
+    if (i < token.size() && token[i] == '-') {
+        ++i;
+    }
+
+    std::size_t digit_count = 0;
+    for (; i < token.size() && token[i] >= '0' && token[i] <= '9'; ++i) {
+        ++digit_count;
+    }
+
+    if (i < token.size() && token[i] == '.') {
+        for (++i; i < token.size() && token[i] >= '0' && token[i] <= '9'; ++i) {
+            ++digit_count;
+        }
+
+        if (i + 1 == token.size() && (token[i] == 'f' || token[i] == 'F')) {
+            token.remove_suffix(1);
+        }
+    }
+
+    return digit_count > 0 && i == token.size();
+}
+
+template <typename T>
+static ConvertResult ConvertFloatingPoint(std::string_view token, T &value) {
+    if (!IsDecimalFloat(token)) {
+        return CONVERT_ERROR_INVALID;
+    }
+
+#if defined(__cpp_lib_to_chars)
+    const char *last = token.data() + token.size();
+    const std::from_chars_result result = std::from_chars(token.data(), last, value, std::chars_format::fixed);
+
+    if (result.ec == std::errc::result_out_of_range) {
+        return CONVERT_ERROR_OUT_OF_RANGE;
+    }
+    if (result.ec != std::errc() || result.ptr != last) {
+        return CONVERT_ERROR_INVALID;
+    }
+#else
+    std::istringstream stream{std::string(token)};
+    stream.imbue(std::locale::classic());
+    stream >> value;
+
+    if (stream.fail()) {
+        return CONVERT_ERROR_INVALID;
+    }
+    if (stream.peek() != std::char_traits<char>::eof()) {
+        return CONVERT_ERROR_INVALID;
+    }
+#endif
+
+    if (!std::isfinite(value)) {
+        return CONVERT_ERROR_OUT_OF_RANGE;
+    }
+
+    return CONVERT_SUCCESS;
+}
+
+ConvertResult ConvertBool32(std::string_view token, VkBool32 &value) {
+    if (EqualsNoCase(token, "true")) {
+        value = VK_TRUE;
+        return CONVERT_SUCCESS;
+    }
+
+    if (EqualsNoCase(token, "false")) {
+        value = VK_FALSE;
+        return CONVERT_SUCCESS;
+    }
+
+    bool negative = false;
+    uint64_t magnitude = 0;
+
+    const ConvertResult result = ConvertMagnitude(token, negative, magnitude);
+    if (result != CONVERT_SUCCESS) {
+        return result;
+    }
+
+    value = magnitude != 0 ? VK_TRUE : VK_FALSE;
+    return CONVERT_SUCCESS;
+}
+
+ConvertResult ConvertInt32(std::string_view token, int32_t &value) { return ConvertSigned(token, value); }
+
+ConvertResult ConvertInt64(std::string_view token, int64_t &value) { return ConvertSigned(token, value); }
+
+ConvertResult ConvertUint32(std::string_view token, uint32_t &value) { return ConvertUnsigned(token, value); }
+
+ConvertResult ConvertUint64(std::string_view token, uint64_t &value) { return ConvertUnsigned(token, value); }
+
+ConvertResult ConvertFloat(std::string_view token, float &value) { return ConvertFloatingPoint(token, value); }
+
+ConvertResult ConvertDouble(std::string_view token, double &value) { return ConvertFloatingPoint(token, value); }
+
+}  // namespace vl
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#pragma once
+
+#include "vulkan/layer/vk_layer_settings.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace vl {
+    enum ConvertResult {
+        CONVERT_SUCCESS = 0,
+        CONVERT_ERROR_INVALID,       // The token is not a value of the requested type
+        CONVERT_ERROR_OUT_OF_RANGE,  // The token is a number that can't be represented by the requested type
+    };
+
+    // Integers are decimal or hexadecimal with a "0x" prefix, optionally negative. Booleans are "true", "false" or an integer.
+    // Floating-point values are decimal, optionally negative, without exponent, and may have a 'f' suffix after the decimal
+    // point. They are parsed independently of the C locale.
+
+    ConvertResult ConvertBool32(std::string_view token, VkBool32 &value);
+
+    ConvertResult ConvertInt32(std::string_view token, int32_t &value);
+
+    ConvertResult ConvertInt64(std::string_view token, int64_t &value);
+
+    ConvertResult ConvertUint32(std::string_view token, uint32_t &value);
+
+    ConvertResult ConvertUint64(std::string_view token, uint64_t &value);
+
+    ConvertResult ConvertFloat(std::string_view token, float &value);
+
+    ConvertResult ConvertDouble(std::string_view token, double &value);
+} // namespace vl
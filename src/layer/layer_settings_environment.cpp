@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include "layer_settings_environment.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <direct.h>
+#define GetCurrentDir _getcwd
+#else
+#include <unistd.h>
+#define GetCurrentDir getcwd
+#endif
+
+#if defined(__APPLE__)
+#include <crt_externs.h>
+#elif !defined(_WIN32)
+extern char **environ;
+#endif
+
+#ifdef __ANDROID__
+#include <sys/system_properties.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <mutex>
+
+namespace vl {
+
+// Call 'visit' with the name and the value of each environment variable, or each system property on Android
+template <typename Visitor>
+static void ForEachEnvironment(Visitor visit) {
+#if defined(__ANDROID__)
+    __system_property_foreach(
+        [](const prop_info *pi, void *cookie) {
+            __system_property_read_callback(
+                pi,
+                [](void *cookie, const char *name, const char *value, uint32_t serial) {
+                    (void)serial;
+                    (*reinterpret_cast<Visitor *>(cookie))(std::string_view(name), std::string_view(value));
+                },
+                cookie);
+        },
+        &visit);
+#elif defined(_WIN32)
+    char *environment = GetEnvironmentStringsA();
+    if (environment == nullptr) {
+        return;
+    }
+
+    for (const char *entry = environment; *entry != '\0'; entry += std::strlen(entry) + 1) {
+        // Skip the first character, hidden variables such as "=C:" start with '='
+        const char *separator = std::strchr(entry + 1, '=');
+        if (separator != nullptr) {
+            visit(std::string_view(entry, separator - entry), std::string_view(separator + 1));
+        }
+    }
+
+    FreeEnvironmentStringsA(environment);
+#else
+#if defined(__APPLE__)
+    char **environment = *_NSGetEnviron();
+#else
+    char **environment = environ;
+#endif
+    for (char **entry = environment; entry != nullptr && *entry != nullptr; ++entry) {
+        const char *separator = std::strchr(*entry, '=');
+        if (separator != nullptr) {
+            visit(std::string_view(*entry, separator - *entry), std::string_view(separator + 1));
+        }
+    }
+#endif
+}
+
+static bool IsEqualVariableName(std::string_view a, std::string_view b) {
+#if defined(_WIN32)
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::toupper(static_cast<unsigned char>(x)) == std::toupper(static_cast<unsigned char>(y));
+           });
+#else
+    return a == b;
+#endif
+}
+
+// Only the variables the layer settings may read are kept, the environment of the process may be large
+static bool IsSnapshotVariable(std::string_view name) {
+#if defined(__ANDROID__)
+    return name.compare(0, 13, "debug.vulkan.") == 0;
+#else
+    static const char *const LOCATION_VARIABLES[] = {"HOME", "XDG_DATA_HOME", "XDG_CACHE_HOME"};
+    for (const char *variable : LOCATION_VARIABLES) {
+        if (IsEqualVariableName(name, variable)) {
+            return true;
+        }
+    }
+    return name.size() > 3 && IsEqualVariableName(name.substr(0, 3), "VK_");
+#endif
+}
+
+static std::string_view ReadWorkingDirectory(char (&buffer)[512]) {
+    return GetCurrentDir(buffer, sizeof(buffer)) != nullptr ? std::string_view(buffer) : std::string_view();
+}
+
+bool EnvironmentSnapshot::IsCurrent() const {
+    // Compared without allocating, in the order of the environment
+    std::size_t index = 0;
+    bool current = true;
+    ForEachEnvironment([this, &index, &current](std::string_view name, std::string_view value) {
+        if (!current || !IsSnapshotVariable(name)) {
+            return;
+        }
+        current = index < this->variables.size() && this->variables[index].first == name && this->variables[index].second == value;
+        ++index;
+    });
+
+    char buffer[512];
+    return current && index == this->variables.size() && ReadWorkingDirectory(buffer) == this->working_directory;
+}
+
+std::shared_ptr<const EnvironmentSnapshot> EnvironmentSnapshot::Capture() {
+    // The last snapshot, shared by the following captures while the environment is unchanged
+    static std::mutex mutex;
+    static std::shared_ptr<const EnvironmentSnapshot> last_snapshot;
+
+    std::shared_ptr<const EnvironmentSnapshot> previous_snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        previous_snapshot = last_snapshot;
+    }
+    if (previous_snapshot != nullptr && previous_snapshot->IsCurrent()) {
+        return previous_snapshot;
+    }
+
+    std::shared_ptr<EnvironmentSnapshot> snapshot(new EnvironmentSnapshot);
+
+    ForEachEnvironment([&snapshot](std::string_view name, std::string_view value) {
+        if (IsSnapshotVariable(name)) {
+            snapshot->variables.emplace_back(std::string(name), std::string(value));
+        }
+    });
+
+    char buffer[512];
+    snapshot->working_directory = ReadWorkingDirectory(buffer);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    last_snapshot = snapshot;
+    return snapshot;
+}
+
+std::string_view EnvironmentSnapshot::Get(std::string_view name) const {
+    for (const auto &variable : this->variables) {
+        if (IsEqualVariableName(variable.first, name)) {
+            return variable.second;
+        }
+    }
+    return std::string_view();
+}
+
+}  // namespace vl
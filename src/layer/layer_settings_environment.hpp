@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace vl {
+    // Environment variables read by the layer settings, or the system properties on Android, and the current directory, read
+    // at once by the thread initializing the layer settings. The layer settings reloaded on another thread use the snapshot of
+    // their initialization, as reading the environment would race with the application modifying it.
+    class EnvironmentSnapshot {
+      public:
+        // Keep the VK_ variables, or the debug.vulkan. properties on Android, and the variables locating the settings file
+        // and its binary cache. The snapshot of the previous call is returned again while the kept variables and the current
+        // directory are unchanged, so that the layer settings and setting sets share it. Throw std::bad_alloc if an
+        // allocation fails.
+        static std::shared_ptr<const EnvironmentSnapshot> Capture();
+
+        // Return an empty string when the variable is not set or not kept. Variable names are case-insensitive on Windows.
+        std::string_view Get(std::string_view name) const;
+
+        // Variables kept, as (name, value) pairs in the order of the environment
+        const std::vector<std::pair<std::string, std::string>> &GetVariables() const { return this->variables; }
+
+        // Empty when the current directory can't be read
+        const std::string &GetWorkingDirectory() const { return this->working_directory; }
+
+      private:
+        EnvironmentSnapshot() = default;
+
+        // Whether the environment still matches the snapshot
+        bool IsCurrent() const;
+
+        std::vector<std::pair<std::string, std::string>> variables;
+        std::string working_directory;
+    };
+} // namespace vl
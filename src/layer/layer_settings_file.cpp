@@ -0,0 +1,597 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include "layer_settings_file.hpp"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace vl {
+
+#if defined(_WIN32)
+// The file index and the volume serial number identify a file as the inode and the device do elsewhere, stat leaves them 0
+static bool GetHandleIdentity(HANDLE file, FileIdentity &identity) {
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!GetFileInformationByHandle(file, &info) || (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
+        return false;
+    }
+
+    identity.size = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+    // In 100 nanoseconds intervals
+    identity.modification_time =
+        static_cast<int64_t>((static_cast<uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) |
+                             info.ftLastWriteTime.dwLowDateTime) * 100;
+    identity.inode = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+    identity.device = static_cast<uint64_t>(info.dwVolumeSerialNumber);
+    return true;
+}
+
+bool GetFileIdentity(const char *pFilename, FileIdentity &identity) {
+    HANDLE file = CreateFileA(pFilename, 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    const bool result = GetHandleIdentity(file, identity);
+    CloseHandle(file);
+    return result;
+}
+#else
+static FileIdentity ToFileIdentity(const struct stat &info) {
+    FileIdentity identity;
+    identity.size = static_cast<uint64_t>(info.st_size);
+#if defined(__APPLE__)
+    identity.modification_time = static_cast<int64_t>(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    identity.modification_time = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+    identity.inode = static_cast<uint64_t>(info.st_ino);
+    identity.device = static_cast<uint64_t>(info.st_dev);
+    return identity;
+}
+
+bool GetFileIdentity(const char *pFilename, FileIdentity &identity) {
+    struct stat info;
+    if (stat(pFilename, &info) != 0 || !(info.st_mode & S_IFREG)) {
+        return false;
+    }
+
+    identity = ToFileIdentity(info);
+    return true;
+}
+#endif
+
+MappedFile::~MappedFile() { this->Close(); }
+
+bool MappedFile::Open(const char *pFilename) {
+    this->Close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(pFilename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    if (!GetHandleIdentity(file, this->identity)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // An empty file can't be mapped
+    if (this->identity.size == 0) {
+        CloseHandle(file);
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return false;
+    }
+
+    // The view keeps the mapping alive
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) {
+        return false;
+    }
+
+    this->size = static_cast<std::size_t>(this->identity.size);
+    this->data = static_cast<const char *>(view);
+#else
+    const int file = open(pFilename, O_RDONLY);
+    if (file == -1) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close(file);
+        return false;
+    }
+    this->identity = ToFileIdentity(info);
+
+    // An empty file can't be mapped
+    if (info.st_size == 0) {
+        close(file);
+        return true;
+    }
+
+    // The mapping remains valid after the file descriptor is closed
+    void *view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+
+    this->size = static_cast<std::size_t>(info.st_size);
+    this->data = static_cast<const char *>(view);
+#endif
+
+    return true;
+}
+
+void MappedFile::Close() {
+    if (this->data == nullptr) {
+        return;
+    }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(this->data);
+#else
+    munmap(const_cast<char *>(this->data), this->size);
+#endif
+
+    this->data = nullptr;
+    this->size = 0;
+    this->identity = FileIdentity();
+}
+
+std::size_t GetSettingsParseThreadCount(std::size_t size) {
+    if (size < PARALLEL_PARSE_MIN_SIZE) {
+        return 1;
+    }
+
+    // Each thread parses at least PARALLEL_PARSE_MIN_SIZE / 2 bytes
+    const std::size_t max_thread_count = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    return std::min<std::size_t>({max_thread_count, size / (PARALLEL_PARSE_MIN_SIZE / 2), 8});
+}
+
+const SettingsFileEntry *SettingsIndex::LowerBound(std::string_view key) const {
+    return std::lower_bound(this->begin(), this->end(), key,
+                            [this](const SettingsFileEntry &entry, std::string_view key) { return this->GetKey(entry) < key; });
+}
+
+const SettingsFileEntry *SettingsIndex::Find(std::string_view key) const {
+    const SettingsFileEntry *entry = this->LowerBound(key);
+    return entry != this->end() && this->GetKey(*entry) == key ? entry : nullptr;
+}
+
+static std::string_view GetEntryKey(std::string_view text, const SettingsFileEntry &entry) {
+    return text.substr(entry.key_offset, entry.key_size);
+}
+
+// In entries sorted by key, where the entries of a key are in text order, keep the last entry of each key
+static void KeepLastEntries(std::string_view text, std::vector<SettingsFileEntry> &entries) {
+    std::size_t kept_count = 0;
+    for (std::size_t i = 0, n = entries.size(); i < n; ++i) {
+        if (i + 1 < n && GetEntryKey(text, entries[i]) == GetEntryKey(text, entries[i + 1])) {
+            continue;
+        }
+        entries[kept_count++] = entries[i];
+    }
+    entries.resize(kept_count);
+}
+
+// Index the settings of 'chunk', a part of 'text', sorted by key with the last occurrence of each key
+static void ParseSettingsChunk(std::string_view text, std::string_view chunk, std::vector<SettingsFileEntry> &entries) {
+    ParseSettingsText(chunk, [&](std::string_view key, std::string_view value) {
+        entries.push_back({static_cast<uint32_t>(key.data() - text.data()), static_cast<uint32_t>(key.size()),
+                           static_cast<uint32_t>(value.data() - text.data()), static_cast<uint32_t>(value.size())});
+    });
+
+    std::stable_sort(entries.begin(), entries.end(), [text](const SettingsFileEntry &a, const SettingsFileEntry &b) {
+        return GetEntryKey(text, a) < GetEntryKey(text, b);
+    });
+    KeepLastEntries(text, entries);
+}
+
+void ParseSettingsText(std::string_view text, std::size_t thread_count, std::vector<SettingsFileEntry> &entries) {
+    entries.clear();
+
+    if (thread_count <= 1 || text.empty()) {
+        ParseSettingsChunk(text, text, entries);
+        return;
+    }
+
+    // Split the text after the newline following each even split point
+    std::vector<std::string_view> chunks;
+    for (std::size_t i = 0, begin = 0; i < thread_count && begin < text.size(); ++i) {
+        std::size_t end = text.size();
+        if (i + 1 < thread_count) {
+            end = text.find('\n', std::max(begin, text.size() * (i + 1) / thread_count));
+            end = end == std::string_view::npos ? text.size() : end + 1;
+        }
+
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+
+    std::vector<std::vector<SettingsFileEntry>> chunk_entries(chunks.size());
+
+    // The first chunk is parsed by the calling thread, as well as the chunks of threads that failed to start
+    std::vector<std::thread> threads;
+    threads.reserve(chunks.size());
+    for (std::size_t i = 1; i < chunks.size(); ++i) {
+        try {
+            threads.emplace_back(ParseSettingsChunk, text, chunks[i], std::ref(chunk_entries[i]));
+        } catch (const std::system_error &) {
+            ParseSettingsChunk(text, chunks[i], chunk_entries[i]);
+        }
+    }
+    ParseSettingsChunk(text, chunks[0], chunk_entries[0]);
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    // Merge the sorted chunks in text order: std::merge puts the entries of the earlier chunks first for equal keys, so that
+    // KeepLastEntries keeps the entries of the later chunks
+    entries.swap(chunk_entries[0]);
+    std::vector<SettingsFileEntry> merged;
+    for (std::size_t i = 1; i < chunk_entries.size(); ++i) {
+        merged.clear();
+        merged.reserve(entries.size() + chunk_entries[i].size());
+        std::merge(entries.begin(), entries.end(), chunk_entries[i].begin(), chunk_entries[i].end(), std::back_inserter(merged),
+                   [text](const SettingsFileEntry &a, const SettingsFileEntry &b) {
+                       return GetEntryKey(text, a) < GetEntryKey(text, b);
+                   });
+        KeepLastEntries(text, merged);
+        entries.swap(merged);
+    }
+}
+
+static const char SETTINGS_CACHE_MAGIC[4] = {'V', 'L', 'S', 'C'};
+static const uint32_t SETTINGS_CACHE_VERSION = 1;
+
+// The cache is laid out as a header, the entries, the settings file path and the strings of the entries
+struct SettingsCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t size;
+    int64_t modification_time;
+    uint64_t inode;
+    uint64_t device;
+    uint32_t path_size;
+    uint32_t entry_count;
+};
+
+// The entries are SettingsFileEntry, which offsets are relative to the start of the strings. They are used in place.
+static_assert(sizeof(SettingsCacheHeader) % alignof(SettingsFileEntry) == 0, "The cache entries must be aligned");
+
+#if !defined(_WIN32) && !defined(__ANDROID__)
+// Create the directory of the cache files and its parent, such as vulkan/layer_settings, but not the cache directory above
+// them: the cache is not used when $XDG_CACHE_HOME or ~/.cache doesn't exist
+static bool CreateCacheDirectories(const std::string &path) {
+    const std::size_t parent_end = path.find_last_of('/');
+    if (parent_end != std::string::npos && parent_end > 0) {
+        mkdir(path.substr(0, parent_end).c_str(), 0755);
+    }
+
+    struct stat info;
+    return mkdir(path.c_str(), 0755) == 0 || (stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFDIR));
+}
+#endif
+
+std::string GetSettingsCacheFile(const char *pSettingsFilename, const EnvironmentSnapshot &environment) {
+#if defined(_WIN32) || defined(__ANDROID__)
+    (void)pSettingsFilename;
+    (void)environment;
+    return "";
+#else
+    if (const std::string_view enabled = environment.Get("VK_LAYER_SETTINGS_CACHE"); enabled == "0" || enabled == "false") {
+        return "";
+    }
+
+    // A relative $XDG_CACHE_HOME is invalid and must be ignored, as per the XDG Base Directory Specification
+    std::string cache_dir;
+    if (const std::string_view xdg_cache_home = environment.Get("XDG_CACHE_HOME"); xdg_cache_home.substr(0, 1) == "/") {
+        cache_dir = xdg_cache_home;
+    } else if (const std::string_view home = environment.Get("HOME"); !home.empty()) {
+        cache_dir = std::string(home) + "/.cache";
+    } else {
+        return "";
+    }
+    cache_dir += "/vulkan/layer_settings";
+
+    // FNV-1a of the path, the cache file of a settings file is replaced when the settings file changes
+    uint64_t hash = 14695981039346656037ull;
+    for (const char *c = pSettingsFilename; *c != '\0'; ++c) {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ull;
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%016llx.bin", static_cast<unsigned long long>(hash));
+    return cache_dir + name;
+#endif
+}
+
+bool ReadSettingsCache(std::string_view cache, const char *pSettingsFilename, const FileIdentity &identity,
+                       SettingsIndex &index) {
+    SettingsCacheHeader header;
+    if (cache.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, cache.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, SETTINGS_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != SETTINGS_CACHE_VERSION) {
+        return false;
+    }
+
+    FileIdentity cache_identity;
+    cache_identity.size = header.size;
+    cache_identity.modification_time = header.modification_time;
+    cache_identity.inode = header.inode;
+    cache_identity.device = header.device;
+    if (!(cache_identity == identity)) {
+        return false;
+    }
+
+    // The entries are used in place, as a mapped file is
+    if (reinterpret_cast<std::uintptr_t>(cache.data()) % alignof(SettingsFileEntry) != 0) {
+        return false;
+    }
+
+    const std::size_t entries_offset = sizeof(header);
+    if (header.entry_count > (cache.size() - entries_offset) / sizeof(SettingsFileEntry)) {
+        return false;
+    }
+    const std::size_t path_offset = entries_offset + static_cast<std::size_t>(header.entry_count) * sizeof(SettingsFileEntry);
+    if (header.path_size > cache.size() - path_offset) {
+        return false;
+    }
+    const std::size_t strings_offset = path_offset + header.path_size;
+
+    if (cache.substr(path_offset, header.path_size) != std::string_view(pSettingsFilename)) {
+        return false;
+    }
+
+    const std::string_view strings = cache.substr(strings_offset);
+    const SettingsFileEntry *entries = reinterpret_cast<const SettingsFileEntry *>(cache.data() + entries_offset);
+
+    // Validate the bounds of the entries before publishing any of them
+    for (std::size_t i = 0; i < header.entry_count; ++i) {
+        const SettingsFileEntry &entry = entries[i];
+        if (static_cast<uint64_t>(entry.key_offset) + entry.key_size > strings.size() ||
+            static_cast<uint64_t>(entry.value_offset) + entry.value_size > strings.size()) {
+            return false;
+        }
+    }
+
+    index.entries = entries;
+    index.entry_count = header.entry_count;
+    index.strings = strings;
+    return true;
+}
+
+bool WriteSettingsCache(const char *pCacheFilename, const char *pSettingsFilename, const FileIdentity &identity,
+                        const SettingsIndex &index) {
+#if defined(_WIN32) || defined(__ANDROID__)
+    (void)pCacheFilename;
+    (void)pSettingsFilename;
+    (void)identity;
+    (void)index;
+    return false;
+#else
+    SettingsCacheHeader header;
+    std::memcpy(header.magic, SETTINGS_CACHE_MAGIC, sizeof(header.magic));
+    header.version = SETTINGS_CACHE_VERSION;
+    header.size = identity.size;
+    header.modification_time = identity.modification_time;
+    header.inode = identity.inode;
+    header.device = identity.device;
+    header.path_size = static_cast<uint32_t>(std::strlen(pSettingsFilename));
+    header.entry_count = static_cast<uint32_t>(index.entry_count);
+
+    // The keys and the values are written one after the other, without the rest of the settings file text
+    std::vector<SettingsFileEntry> entries;
+    entries.reserve(index.entry_count);
+
+    uint64_t strings_size = 0;
+    for (const SettingsFileEntry &index_entry : index) {
+        SettingsFileEntry entry;
+        entry.key_offset = static_cast<uint32_t>(strings_size);
+        entry.key_size = index_entry.key_size;
+        entry.value_offset = static_cast<uint32_t>(strings_size + index_entry.key_size);
+        entry.value_size = index_entry.value_size;
+        entries.push_back(entry);
+
+        strings_size += static_cast<uint64_t>(index_entry.key_size) + index_entry.value_size;
+        if (strings_size > UINT32_MAX) {
+            return false;
+        }
+    }
+
+    const std::string cache_filename(pCacheFilename);
+    const std::size_t dir_end = cache_filename.find_last_of('/');
+    if (dir_end != std::string::npos && !CreateCacheDirectories(cache_filename.substr(0, dir_end))) {
+        return false;
+    }
+
+    // Write a temporary file that is renamed so that concurrent processes never read a partial cache
+    const std::string temp_filename = cache_filename + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream file(temp_filename, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(entries.data()),
+                   static_cast<std::streamsize>(entries.size() * sizeof(SettingsFileEntry)));
+        file.write(pSettingsFilename, header.path_size);
+        for (const SettingsFileEntry &entry : index) {
+            file.write(index.strings.data() + entry.key_offset, static_cast<std::streamsize>(entry.key_size));
+            file.write(index.strings.data() + entry.value_offset, static_cast<std::streamsize>(entry.value_size));
+        }
+
+        if (!file.good()) {
+            file.close();
+            std::remove(temp_filename.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(temp_filename.c_str(), pCacheFilename) != 0) {
+        std::remove(temp_filename.c_str());
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+std::shared_ptr<const SettingsFile> SettingsFile::Acquire(const std::string &filename, const EnvironmentSnapshot &environment) {
+    FileIdentity identity;
+    if (!GetFileIdentity(filename.c_str(), identity)) {
+        return std::shared_ptr<const SettingsFile>(new SettingsFile);
+    }
+
+    // The lock of each file serializes its parses, so that it is parsed once by concurrent callers while the other files are
+    // parsed in parallel. The registry lock is only held to find the file.
+    struct SharedFile {
+        std::mutex mutex;
+        std::weak_ptr<const SettingsFile> file;
+    };
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<SharedFile>> files;
+
+    std::shared_ptr<SharedFile> shared_file;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Forget the files released and not being parsed, only referenced by the registry
+        for (auto it = files.begin(); it != files.end();) {
+            it = it->second.use_count() == 1 && it->second->file.expired() ? files.erase(it) : std::next(it);
+        }
+
+        std::shared_ptr<SharedFile> &registered_file = files[filename];
+        if (registered_file == nullptr) {
+            registered_file = std::make_shared<SharedFile>();
+        }
+        shared_file = registered_file;
+    }
+
+    std::lock_guard<std::mutex> lock(shared_file->mutex);
+
+    std::shared_ptr<const SettingsFile> file = shared_file->file.lock();
+    if (file != nullptr && file->identity == identity) {
+        return file;
+    }
+
+    std::shared_ptr<SettingsFile> parsed_file(new SettingsFile);
+    parsed_file->identity = identity;
+    parsed_file->Parse(filename.c_str(), environment);
+
+    shared_file->file = parsed_file;
+    return parsed_file;
+}
+
+void SettingsFile::Parse(const char *pFilename, const EnvironmentSnapshot &environment) {
+    // Use the binary cache of the settings file when the file didn't change since the cache was written
+    const std::string cache_file = GetSettingsCacheFile(pFilename, environment);
+
+    if (!cache_file.empty() && this->cache.Open(cache_file.c_str()) &&
+        ReadSettingsCache(this->cache.GetText(), pFilename, this->identity, this->index)) {
+        // The settings are found in the mapped cache, which is replaced by a rename when it is written again
+        return;
+    }
+    this->cache.Close();
+
+    // Extract option = value pairs from a file, the last occurrence of an option wins
+    MappedFile settings_file;
+    if (!settings_file.Open(pFilename)) {
+        return;
+    }
+    this->identity = settings_file.GetIdentity();
+
+    // The entries are 32 bits offsets into the text
+    if (settings_file.GetText().size() > UINT32_MAX) {
+        return;
+    }
+
+    // The text is copied at once. The settings of all the layers are indexed, without copying or trimming their values: each
+    // layer only decodes the values of its own settings, through a SettingsFileView.
+    this->storage.assign(settings_file.GetText());
+    settings_file.Close();
+
+    ParseSettingsText(this->storage, GetSettingsParseThreadCount(this->storage.size()), this->entries);
+    this->index = SettingsIndex{this->entries.data(), this->entries.size(), this->storage};
+
+    if (!cache_file.empty()) {
+        WriteSettingsCache(cache_file.c_str(), pFilename, this->identity, this->index);
+    }
+}
+
+SettingsFileView::SettingsFileView(std::shared_ptr<const SettingsFile> file, std::string_view key_prefix)
+    : file(std::move(file)), key_prefix(key_prefix), index(&this->file->GetIndex()) {
+    this->first = this->index->LowerBound(key_prefix);
+    this->last = this->first;
+    while (this->last != this->index->end() && this->index->GetKey(*this->last).compare(0, key_prefix.size(), key_prefix) == 0) {
+        ++this->last;
+    }
+}
+
+bool SettingsFileView::Find(std::string_view key, std::string_view &value) const {
+    if (this->file == nullptr || key.compare(0, this->key_prefix.size(), this->key_prefix) != 0) {
+        return false;
+    }
+
+    const SettingsFileEntry *entry =
+        std::lower_bound(this->first, this->last, key, [this](const SettingsFileEntry &entry, std::string_view key) {
+            return this->index->GetKey(entry) < key;
+        });
+    if (entry == this->last || this->index->GetKey(*entry) != key) {
+        return false;
+    }
+
+    value = this->index->GetValue(*entry);
+    return true;
+}
+
+}  // namespace vl
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "layer_settings_environment.hpp"
+
+namespace vl {
+    // Identifies a version of a file: any edit changes the size or the modification time
+    struct FileIdentity {
+        uint64_t size{0};
+        int64_t modification_time{0};  // In nanoseconds
+        uint64_t inode{0};   // File index on Windows
+        uint64_t device{0};  // Volume serial number on Windows
+
+        bool operator==(const FileIdentity &other) const {
+            return size == other.size && modification_time == other.modification_time && inode == other.inode &&
+                   device == other.device;
+        }
+    };
+
+    bool GetFileIdentity(const char *pFilename, FileIdentity &identity);
+
+    // Read-only content of a file mapped in memory, empty when the file can't be opened. The mapping is meant to be short-lived:
+    // on Linux, the content of a mapped file modified in place changes under the reader, or raises SIGBUS when the file is
+    // truncated, and on Windows a mapped file can't be truncated. The binary caches of the settings files remain mapped, as
+    // they are never modified in place.
+    class MappedFile {
+      public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        bool Open(const char *pFilename);
+        void Close();
+
+        std::string_view GetText() const { return std::string_view(this->data, this->size); }
+
+        // Identity of the file when it was mapped
+        const FileIdentity &GetIdentity() const { return this->identity; }
+
+      private:
+        const char *data{nullptr};
+        std::size_t size{0};
+        FileIdentity identity;
+    };
+
+    inline bool IsSettingsFileWhitespace(char c) {
+        return c == ' ' || c == '\t' || c == '\f' || c == '\v' || c == '\n' || c == '\r';
+    }
+
+    // Return the position following the end of the line at 'cursor'
+    inline const char *SkipSettingsFileLine(const char *cursor, const char *end) {
+        if (cursor >= end) {
+            return end;
+        }
+
+        const std::size_t size = static_cast<std::size_t>(end - cursor);
+        const void *newline = std::memchr(cursor, '\n', size);
+        return newline == nullptr ? end : static_cast<const char *>(newline) + 1;
+    }
+
+    // Call 'visitor(key, value)' for each "key = value" line of a vk_layer_settings.txt text, in order. Comments start with
+    // '#'. Keys and values are views into 'text'. Keys are trimmed of whitespace, values are the raw text following '=' and
+    // are only trimmed by TrimSettingsValue when they are used, so that the values of the other layers are never decoded.
+    template <typename Visitor>
+    void ParseSettingsText(std::string_view text, Visitor &&visitor) {
+        const char *cursor = text.data();
+        const char *const end = cursor + text.size();
+
+        while (cursor < end) {
+            const char *key_begin = cursor;
+            while (key_begin < end && *key_begin != '\n' && IsSettingsFileWhitespace(*key_begin)) ++key_begin;
+
+            // Single scan for the end of the line, the start of a comment and the first '='
+            const char *equal = nullptr;
+            for (cursor = key_begin; cursor < end; ++cursor) {
+                const char c = *cursor;
+                if (c == '\n' || c == '#') {
+                    break;
+                } else if (c == '=' && equal == nullptr) {
+                    equal = cursor;
+                }
+            }
+            const char *const line_end = cursor;
+
+            // Skip the rest of a comment line
+            cursor = SkipSettingsFileLine(cursor, end);
+
+            if (equal == nullptr) {
+                continue;
+            }
+
+            const char *key_end = equal;
+            while (key_end > key_begin && IsSettingsFileWhitespace(key_end[-1])) --key_end;
+
+            visitor(std::string_view(key_begin, static_cast<std::size_t>(key_end - key_begin)),
+                    std::string_view(equal + 1, static_cast<std::size_t>(line_end - (equal + 1))));
+        }
+    }
+
+    inline std::string_view TrimSettingsValue(std::string_view value) {
+        std::size_t begin = 0;
+        std::size_t end = value.size();
+        while (begin < end && IsSettingsFileWhitespace(value[begin])) ++begin;
+        while (end > begin && IsSettingsFileWhitespace(value[end - 1])) --end;
+        return value.substr(begin, end - begin);
+    }
+
+    // A "key = value" line of a settings file, as offsets into the strings of a SettingsIndex. The value is not trimmed.
+    struct SettingsFileEntry {
+        uint32_t key_offset;
+        uint32_t key_size;
+        uint32_t value_offset;
+        uint32_t value_size;
+    };
+
+    // Entries of a settings file sorted by key, one per key, and the strings they point into. Finding a key takes a binary
+    // search, the value is trimmed when it is read.
+    struct SettingsIndex {
+        const SettingsFileEntry *entries{nullptr};
+        std::size_t entry_count{0};
+        std::string_view strings;
+
+        const SettingsFileEntry *begin() const { return this->entries; }
+        const SettingsFileEntry *end() const { return this->entries + this->entry_count; }
+
+        std::string_view GetKey(const SettingsFileEntry &entry) const {
+            return this->strings.substr(entry.key_offset, entry.key_size);
+        }
+        std::string_view GetValue(const SettingsFileEntry &entry) const {
+            return TrimSettingsValue(this->strings.substr(entry.value_offset, entry.value_size));
+        }
+
+        // First entry which key is not less than 'key'
+        const SettingsFileEntry *LowerBound(std::string_view key) const;
+        // Return nullptr when 'key' is not in the index
+        const SettingsFileEntry *Find(std::string_view key) const;
+    };
+
+    // Settings files from this size are parsed on multiple threads
+    static const std::size_t PARALLEL_PARSE_MIN_SIZE = 1 << 20;
+
+    // Number of threads used to parse a settings file of 'size' bytes
+    std::size_t GetSettingsParseThreadCount(std::size_t size);
+
+    // Index the settings of 'text' into 'entries', which offsets are relative to 'text', sorted by key. The text is split at
+    // line boundaries in 'thread_count' chunks indexed concurrently. The last occurrence of a key wins, as with a sequential
+    // parse. 'text' must be smaller than 4 GB.
+    void ParseSettingsText(std::string_view text, std::size_t thread_count, std::vector<SettingsFileEntry> &entries);
+
+    // Binary cache of a parsed vk_layer_settings.txt, stored in $XDG_CACHE_HOME/vulkan/layer_settings so that
+    // processes can use the settings of an unchanged file without parsing it. Setting VK_LAYER_SETTINGS_CACHE to 0 disables
+    // it. Only the vulkan/layer_settings directories are created: without a cache directory, the cache is silently not used.
+    // A cache file is only ever replaced by a rename, never modified in place, so that it can remain mapped.
+
+    // Return the cache file of a settings file, or an empty string when the cache is disabled or not supported
+    std::string GetSettingsCacheFile(const char *pSettingsFilename, const EnvironmentSnapshot &environment);
+
+    // Point 'index' into 'cache'. Return false when the cache is corrupted or doesn't match the settings file.
+    bool ReadSettingsCache(std::string_view cache, const char *pSettingsFilename, const FileIdentity &identity,
+                           SettingsIndex &index);
+
+    bool WriteSettingsCache(const char *pCacheFilename, const char *pSettingsFilename, const FileIdentity &identity,
+                            const SettingsIndex &index);
+
+    // Settings of a vk_layer_settings.txt, parsed once per process and shared by the LayerSettings of all the layers, for
+    // example by the instances created concurrently, for as long as the file is unchanged.
+    class SettingsFile {
+      public:
+        // Return the parsed settings, shared with the previous callers if the file is unchanged since they parsed it.
+        // The file is released when the last reference is. The cache location is found in 'environment'. Thread-safe.
+        static std::shared_ptr<const SettingsFile> Acquire(const std::string &filename, const EnvironmentSnapshot &environment);
+
+        SettingsFile(const SettingsFile &) = delete;
+        SettingsFile &operator=(const SettingsFile &) = delete;
+
+        // Keys and values are views into the storage or the mapped cache of the SettingsFile, they remain valid when the file is
+        // later modified
+        const SettingsIndex &GetIndex() const { return this->index; }
+
+      private:
+        SettingsFile() = default;
+        void Parse(const char *pFilename, const EnvironmentSnapshot &environment);
+
+        // The settings file is only mapped during the parse, then its text is copied in 'storage' and indexed in 'entries'.
+        // A binary cache matching the settings file remains mapped and is used in place instead.
+        MappedFile cache;
+        std::string storage;
+        std::vector<SettingsFileEntry> entries;
+        SettingsIndex index;
+        FileIdentity identity;
+    };
+
+    // Settings of a SettingsFile which keys start with a prefix, such as the settings of a layer. 'key_prefix' must outlive the
+    // view.
+    class SettingsFileView {
+      public:
+        // Iterates over the (key, value) pairs of the view, which values are trimmed as they are read
+        class Iterator {
+          public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::pair<std::string_view, std::string_view>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const value_type *;
+            using reference = value_type;
+
+            Iterator() = default;
+            Iterator(const SettingsIndex *index, const SettingsFileEntry *entry) : index(index), entry(entry) {}
+
+            value_type operator*() const {
+                return value_type(this->index->GetKey(*this->entry), this->index->GetValue(*this->entry));
+            }
+            Iterator &operator++() {
+                ++this->entry;
+                return *this;
+            }
+            bool operator==(const Iterator &other) const { return this->entry == other.entry; }
+            bool operator!=(const Iterator &other) const { return this->entry != other.entry; }
+
+          private:
+            const SettingsIndex *index{nullptr};
+            const SettingsFileEntry *entry{nullptr};
+        };
+
+        SettingsFileView() = default;
+        SettingsFileView(std::shared_ptr<const SettingsFile> file, std::string_view key_prefix);
+
+        Iterator begin() const { return Iterator(this->index, this->first); }
+        Iterator end() const { return Iterator(this->index, this->last); }
+        std::size_t size() const { return static_cast<std::size_t>(this->last - this->first); }
+
+        // Return false when 'key' is not in the view
+        bool Find(std::string_view key, std::string_view &value) const;
+
+      private:
+        std::shared_ptr<const SettingsFile> file;
+        std::string_view key_prefix;
+        const SettingsIndex *index{nullptr};
+        const SettingsFileEntry *first{nullptr};
+        const SettingsFileEntry *last{nullptr};
+    };
+} // namespace vl
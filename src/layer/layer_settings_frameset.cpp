@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include "layer_settings_frameset.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace vl {
+
+FramesetIndex::FramesetIndex(const VkFrameset *pFramesets, std::size_t count, Arena *arena)
+    : bitmap(arena), intervals(arena), strided(arena), steps(arena) {
+    this->intervals.reserve(count);
+    this->strided.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const VkFrameset &frameset = pFramesets[i];
+        if (frameset.count == 0) {
+            continue;
+        }
+
+        if (frameset.count == 1 || frameset.step <= 1) {
+            // A step of 0 selects the first frame only
+            const uint64_t size = frameset.step == 0 ? 1 : frameset.count;
+            this->intervals.push_back(Interval{frameset.first, frameset.first + size});
+            this->frame_end = std::max(this->frame_end, this->intervals.back().end);
+        } else {
+            const uint64_t first_multiple = frameset.first / frameset.step;
+            this->strided.push_back(StridedInterval{frameset.step, frameset.first % frameset.step,
+                                                    Interval{first_multiple, first_multiple + frameset.count}});
+            this->frame_end = std::max(this->frame_end, frameset.first + static_cast<uint64_t>(frameset.count - 1) * frameset.step + 1);
+        }
+    }
+
+    // Merge the overlapping and adjacent intervals
+    std::sort(this->intervals.begin(), this->intervals.end(),
+              [](const Interval &a, const Interval &b) { return a.first < b.first; });
+
+    std::size_t merged_count = 0;
+    for (const Interval &interval : this->intervals) {
+        if (merged_count > 0 && interval.first <= this->intervals[merged_count - 1].end) {
+            Interval &merged = this->intervals[merged_count - 1];
+            merged.end = std::max(merged.end, interval.end);
+        } else {
+            this->intervals[merged_count++] = interval;
+        }
+    }
+    this->intervals.resize(merged_count);
+
+    // Framesets with the same step and residue select multiples of the step, merged as the intervals above
+    std::sort(this->strided.begin(), this->strided.end(), [](const StridedInterval &a, const StridedInterval &b) {
+        if (a.step != b.step) {
+            return a.step < b.step;
+        }
+        return a.residue != b.residue ? a.residue < b.residue : a.multiples.first < b.multiples.first;
+    });
+
+    merged_count = 0;
+    for (std::size_t i = 0; i < this->strided.size(); ++i) {
+        const StridedInterval interval = this->strided[i];
+        StridedInterval *merged = merged_count > 0 ? &this->strided[merged_count - 1] : nullptr;
+        if (merged != nullptr && merged->step == interval.step && merged->residue == interval.residue &&
+            interval.multiples.first <= merged->multiples.end) {
+            merged->multiples.end = std::max(merged->multiples.end, interval.multiples.end);
+        } else {
+            this->strided[merged_count++] = interval;
+        }
+    }
+    this->strided.resize(merged_count);
+
+    for (std::size_t i = 0; i < this->strided.size(); ++i) {
+        if (this->steps.empty() || this->steps.back().step != this->strided[i].step) {
+            this->steps.push_back(StepRange{this->strided[i].step, static_cast<uint32_t>(i), 0});
+        }
+        this->steps.back().end = static_cast<uint32_t>(i + 1);
+    }
+
+    // Frames in the bitmap
+    this->bitmap_frame_count = static_cast<uint32_t>(std::min<uint64_t>(this->frame_end, MAX_BITMAP_FRAME_COUNT));
+    this->bitmap.resize((this->bitmap_frame_count + 63) / 64);
+
+    for (const Interval &interval : this->intervals) {
+        const uint64_t end = std::min<uint64_t>(interval.end, this->bitmap_frame_count);
+        for (uint64_t frame = interval.first; frame < end; ++frame) {
+            this->bitmap[frame / 64] |= uint64_t(1) << (frame % 64);
+        }
+    }
+
+    for (const StridedInterval &interval : this->strided) {
+        for (uint64_t multiple = interval.multiples.first, frame = interval.residue + multiple * interval.step;
+             multiple < interval.multiples.end && frame < this->bitmap_frame_count; ++multiple, frame += interval.step) {
+            this->bitmap[frame / 64] |= uint64_t(1) << (frame % 64);
+        }
+    }
+}
+
+bool FramesetIndex::Contains(uint32_t frame) const {
+    if (frame < this->bitmap_frame_count) {
+        return (this->bitmap[frame / 64] & (uint64_t(1) << (frame % 64))) != 0;
+    }
+
+    if (frame >= this->frame_end) {
+        return false;
+    }
+
+    // Last interval starting at or before 'frame'
+    auto it = std::upper_bound(this->intervals.begin(), this->intervals.end(), frame,
+                               [](uint64_t value, const Interval &interval) { return value < interval.first; });
+    if (it != this->intervals.begin() && frame < (it - 1)->end) {
+        return true;
+    }
+
+    // Last strided interval of each step with the residue of 'frame', starting at or before its multiple
+    for (const StepRange &step_range : this->steps) {
+        const uint32_t residue = frame % step_range.step;
+        const uint64_t multiple = frame / step_range.step;
+
+        auto begin = this->strided.begin() + step_range.begin;
+        auto end = this->strided.begin() + step_range.end;
+        auto strided_it = std::upper_bound(begin, end, std::make_pair(residue, multiple),
+                                           [](const std::pair<uint32_t, uint64_t> &value, const StridedInterval &interval) {
+                                               return value.first != interval.residue ? value.first < interval.residue
+                                                                                      : value.second < interval.multiples.first;
+                                           });
+        if (strided_it != begin && (strided_it - 1)->residue == residue && multiple < (strided_it - 1)->multiples.end) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}  // namespace vl
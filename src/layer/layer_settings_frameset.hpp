@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#pragma once
+
+#include "vulkan/layer/vk_layer_settings.h"
+#include "layer_settings_arena.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vl {
+    // Frames selected by a list of VkFrameset, for example from vl::ToFrameSets. The first MAX_BITMAP_FRAME_COUNT frames
+    // are queried in constant time from a bitmap. Later frames are queried with a binary search over the merged sorted
+    // intervals, then, for each distinct step larger than 1, a binary search over the framesets of that step with the same
+    // remainder as the frame. The index is stored in 'arena', or in the global heap without arena.
+    class FramesetIndex {
+      public:
+        static const uint32_t MAX_BITMAP_FRAME_COUNT = 1 << 16;
+
+        FramesetIndex() = default;
+        FramesetIndex(const VkFrameset *pFramesets, std::size_t count, Arena *arena = nullptr);
+
+        bool Contains(uint32_t frame) const;
+
+      private:
+        // Frames [first, end)
+        struct Interval {
+            uint64_t first;
+            uint64_t end;
+        };
+
+        // Frames 'residue' + k * 'step' for k in [first, end)
+        struct StridedInterval {
+            uint32_t step;
+            uint32_t residue;
+            Interval multiples;
+        };
+
+        // The strided intervals of a step are [begin, end) in 'strided'
+        struct StepRange {
+            uint32_t step;
+            uint32_t begin;
+            uint32_t end;
+        };
+
+        uint64_t frame_end{0};  // No frame is selected from 'frame_end'
+        ArenaVector<uint64_t> bitmap;
+        uint32_t bitmap_frame_count{0};
+        ArenaVector<Interval> intervals;  // Sorted, without overlap
+        ArenaVector<StridedInterval> strided;  // Framesets with a step larger than 1, sorted by step, residue and multiples
+        ArenaVector<StepRange> steps;
+    };
+} // namespace vl
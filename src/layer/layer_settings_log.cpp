@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include "layer_settings_log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <system_error>
+
+namespace vl {
+
+// Interval between two reports of the repetitions counted while the drain thread is awake
+static const std::chrono::milliseconds REPORT_INTERVAL(1000);
+
+// Deadline of the drain thread sleeping while there is nothing to deliver nor report
+static const std::chrono::steady_clock::time_point NO_DEADLINE = std::chrono::steady_clock::time_point::max();
+
+// Entries of the repetition table probed for a message before giving up on counting its repetitions
+static const std::size_t REPETITION_PROBE_COUNT = 16;
+
+static void CopyTruncated(char *destination, std::size_t size, const char *source) {
+    std::size_t length = 0;
+    while (length + 1 < size && source[length] != '\0') {
+        ++length;
+    }
+
+    std::memcpy(destination, source, length);
+    destination[length] = '\0';
+}
+
+// Set once the log is constructed
+static std::atomic<SettingsLog *> settings_log_instance{nullptr};
+
+SettingsLog &SettingsLog::Get() {
+    // Constructed in static storage and never destroyed, so that the messages logged by the destructors of other static
+    // objects are still delivered
+    alignas(SettingsLog) static unsigned char storage[sizeof(SettingsLog)];
+    static SettingsLog *log = new (storage) SettingsLog;
+    return *log;
+}
+
+// Stops the drain thread at exit, or when the library is unloaded before its code is unmapped
+static struct SettingsLogStopper {
+    ~SettingsLogStopper() {
+        SettingsLog *log = settings_log_instance.load(std::memory_order_acquire);
+        if (log != nullptr) {
+            log->Stop();
+        }
+    }
+} settings_log_stopper;
+
+SettingsLog::SettingsLog() {
+    for (std::size_t i = 0; i < RING_CAPACITY; ++i) {
+        this->slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    settings_log_instance.store(this, std::memory_order_release);
+}
+
+void SettingsLog::StartThread() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->thread_state.load(std::memory_order_relaxed) != THREAD_NOT_STARTED) {
+        return;
+    }
+
+    try {
+        this->thread = std::thread(&SettingsLog::Run, this);
+        this->thread_state.store(THREAD_RUNNING, std::memory_order_release);
+    } catch (const std::system_error &) {
+        // The messages are delivered by the threads that log them
+        this->thread_state.store(THREAD_STOPPED, std::memory_order_release);
+    }
+}
+
+void SettingsLog::WakeThread() {
+    // Locked so that the notification can't fall between the drain thread checking for work and going to sleep
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->wake_condition.notify_one();
+}
+
+void SettingsLog::Deliver(VL_LAYER_SETTING_LOG_CALLBACK callback, const char *pSettingName, const char *pMessage) {
+    if (callback == nullptr) {
+        fprintf(stderr, "LAYER SETTING (%s) error: %s\n", pSettingName, pMessage);
+    } else {
+        callback(pSettingName, pMessage);
+    }
+}
+
+void SettingsLog::Push(uint64_t source, VL_LAYER_SETTING_LOG_CALLBACK callback, const char *pSettingName, const char *pMessage) {
+    uint32_t thread_state = this->thread_state.load(std::memory_order_acquire);
+    if (thread_state == THREAD_NOT_STARTED) {
+        this->StartThread();
+        thread_state = this->thread_state.load(std::memory_order_acquire);
+    }
+    if (thread_state != THREAD_RUNNING) {
+        std::lock_guard<std::mutex> lock(this->synchronous_mutex);
+        Deliver(callback, pSettingName, pMessage);
+        return;
+    }
+
+    // FNV-1a of the source, the setting name and the message, 0 marks the free entries of the repetition table
+    uint64_t key = 14695981039346656037ull;
+    for (std::size_t i = 0; i < sizeof(source); ++i) {
+        key = (key ^ ((source >> (i * 8)) & 0xFF)) * 1099511628211ull;
+    }
+    for (const char *c = pSettingName; *c != '\0'; ++c) {
+        key = (key ^ static_cast<unsigned char>(*c)) * 1099511628211ull;
+    }
+    key = (key ^ 0xFF) * 1099511628211ull;
+    for (const char *c = pMessage; *c != '\0'; ++c) {
+        key = (key ^ static_cast<unsigned char>(*c)) * 1099511628211ull;
+    }
+    key = key == 0 ? 1 : key;
+
+    // A repeated message is only counted
+    if (this->CountRepetition(key)) {
+        return;
+    }
+
+    // Claim the slot at the enqueue position, its sequence is equal to the position when it is free
+    uint64_t position = this->enqueue_position.load(std::memory_order_relaxed);
+    Slot *slot = nullptr;
+    for (;;) {
+        slot = &this->slots[position % RING_CAPACITY];
+        const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const int64_t difference = static_cast<int64_t>(sequence - position);
+        if (difference == 0) {
+            if (this->enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // The ring buffer is full. No entry of the repetition table is claimed yet, so the repetitions of the dropped
+            // message are dropped as well.
+            this->dropped_count.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (this->drain_idle.load(std::memory_order_relaxed)) {
+                this->WakeThread();
+            }
+            return;
+        } else {
+            position = this->enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Claimed once the slot is, so that a producer never frees an entry that other producers may be counting in
+    slot->repetition_index = this->ClaimRepetition(key, slot->repeated);
+    if (!slot->repeated) {
+        slot->source = source;
+        slot->callback = callback;
+        const std::size_t setting_name_length = std::strlen(pSettingName);
+        if (setting_name_length < SETTING_NAME_SIZE) {
+            std::memcpy(slot->setting_name, pSettingName, setting_name_length + 1);
+        } else {
+            try {
+                slot->long_setting_name.assign(pSettingName, setting_name_length);
+            } catch (const std::bad_alloc &) {
+                CopyTruncated(slot->setting_name, SETTING_NAME_SIZE, pSettingName);
+            }
+        }
+        CopyTruncated(slot->message, MESSAGE_SIZE, pMessage);
+    }
+    slot->sequence.store(position + 1, std::memory_order_release);
+
+    // Pairs with the fence of the drain thread before it goes to sleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->drain_sleeping.load(std::memory_order_relaxed)) {
+        this->WakeThread();
+    }
+}
+
+bool SettingsLog::CountRepetition(uint64_t key) {
+    for (std::size_t probe = 0; probe < REPETITION_PROBE_COUNT; ++probe) {
+        Repetition &repetition = this->repetitions[static_cast<std::size_t>((key + probe) % REPETITION_CAPACITY)];
+        if (repetition.key.load(std::memory_order_acquire) != key) {
+            continue;
+        }
+
+        repetition.count.fetch_add(1, std::memory_order_relaxed);
+
+        // Pairs with the fence of the drain thread before it goes to sleep without deadline
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (this->drain_idle.load(std::memory_order_relaxed)) {
+            this->WakeThread();
+        }
+        return true;
+    }
+    return false;
+}
+
+std::size_t SettingsLog::ClaimRepetition(uint64_t key, bool &repeated) {
+    repeated = false;
+    for (std::size_t probe = 0; probe < REPETITION_PROBE_COUNT; ++probe) {
+        const std::size_t index = static_cast<std::size_t>((key + probe) % REPETITION_CAPACITY);
+        Repetition &repetition = this->repetitions[index];
+
+        uint64_t current_key = repetition.key.load(std::memory_order_acquire);
+        if (current_key == 0 && repetition.key.compare_exchange_strong(current_key, key, std::memory_order_acq_rel)) {
+            return index;
+        }
+        if (current_key == key) {
+            // Claimed by a concurrent producer of the same message
+            repetition.count.fetch_add(1, std::memory_order_relaxed);
+            repeated = true;
+            return REPETITION_CAPACITY;
+        }
+    }
+    return REPETITION_CAPACITY;
+}
+
+void SettingsLog::ReleaseSource(uint64_t source) {
+    // The source didn't push any message to the drain thread
+    if (this->thread_state.load(std::memory_order_acquire) != THREAD_RUNNING) {
+        return;
+    }
+
+    const uint64_t position = this->enqueue_position.load(std::memory_order_acquire);
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    try {
+        this->released_sources.emplace_back(source, position);
+    } catch (const std::bad_alloc &) {
+        // The entries of the source remain used, the repetitions of its messages are still reported
+    }
+    if (this->drain_idle.load(std::memory_order_relaxed)) {
+        this->wake_condition.notify_one();
+    }
+}
+
+void SettingsLog::Flush() {
+    // Called when the drain thread is not running, or by a log callback
+    if (this->thread_state.load(std::memory_order_acquire) != THREAD_RUNNING ||
+        std::this_thread::get_id() == this->thread.get_id()) {
+        return;
+    }
+
+    const uint64_t position = this->enqueue_position.load(std::memory_order_acquire);
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    const uint64_t request = ++this->flush_request_count;
+    this->flush_position = std::max(this->flush_position, position);
+    this->wake_condition.notify_one();
+    while (this->flush_done_count < request && this->thread_state.load(std::memory_order_acquire) == THREAD_RUNNING) {
+        this->flushed_condition.wait_for(lock, REPORT_INTERVAL);
+    }
+}
+
+void SettingsLog::Stop() {
+    {
+        // No message was logged, the thread is not started afterward
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->thread_state.load(std::memory_order_relaxed) == THREAD_NOT_STARTED) {
+            this->thread_state.store(THREAD_STOPPED, std::memory_order_release);
+            return;
+        }
+    }
+
+    // Stopped by a log callback calling exit
+    if (this->thread_state.load(std::memory_order_acquire) != THREAD_RUNNING ||
+        std::this_thread::get_id() == this->thread.get_id()) {
+        return;
+    }
+
+    this->Flush();
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+        this->thread_state.store(THREAD_STOPPED, std::memory_order_release);
+    }
+    this->wake_condition.notify_one();
+    this->thread.join();
+
+    // The messages pushed while the thread was stopping
+    while (this->Drain()) {
+    }
+    this->ReportRepetitions();
+
+    // Free the memory of the log, which is never destroyed
+    std::unordered_map<std::size_t, DeliveredMessage>().swap(this->delivered_messages);
+    std::vector<std::pair<uint64_t, uint64_t>>().swap(this->released_sources);
+}
+
+bool SettingsLog::Drain() {
+    const uint64_t position = this->dequeue_position.load(std::memory_order_relaxed);
+    Slot &slot = this->slots[position % RING_CAPACITY];
+    if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+        return false;
+    }
+
+    if (slot.repeated) {
+        slot.sequence.store(position + RING_CAPACITY, std::memory_order_release);
+        this->dequeue_position.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    const char *pSettingName = slot.long_setting_name.empty() ? slot.setting_name : slot.long_setting_name.c_str();
+
+    if (slot.repetition_index != REPETITION_CAPACITY) {
+        try {
+            DeliveredMessage &delivered_message = this->delivered_messages[slot.repetition_index];
+            delivered_message.source = slot.source;
+            delivered_message.callback = slot.callback;
+            delivered_message.setting_name = pSettingName;
+            delivered_message.message = slot.message;
+            delivered_message.reported_count = 0;
+        } catch (const std::bad_alloc &) {
+            // The repetitions of the message can't be reported. The entry remains claimed, as producers may be counting in
+            // it, so they are not delivered either.
+            this->delivered_messages.erase(slot.repetition_index);
+        }
+    }
+
+    Deliver(slot.callback, pSettingName, slot.message);
+    std::string().swap(slot.long_setting_name);
+
+    // Free the slot for the position of the next round
+    slot.sequence.store(position + RING_CAPACITY, std::memory_order_release);
+    this->dequeue_position.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+void SettingsLog::ReportRepetition(std::size_t repetition_index, DeliveredMessage &delivered_message) {
+    const uint32_t count = this->repetitions[repetition_index].count.load(std::memory_order_relaxed);
+    if (count == delivered_message.reported_count) {
+        return;
+    }
+
+    try {
+        const std::string message =
+            delivered_message.message + " (repeated " + std::to_string(count - delivered_message.reported_count) + " more times)";
+        Deliver(delivered_message.callback, delivered_message.setting_name.c_str(), message.c_str());
+    } catch (const std::bad_alloc &) {
+        Deliver(delivered_message.callback, delivered_message.setting_name.c_str(), delivered_message.message.c_str());
+    }
+    delivered_message.reported_count = count;
+}
+
+void SettingsLog::ReportRepetitions() {
+    for (auto &it : this->delivered_messages) {
+        this->ReportRepetition(it.first, it.second);
+    }
+
+    const uint32_t dropped_count = this->dropped_count.exchange(0, std::memory_order_relaxed);
+    if (dropped_count > 0) {
+        fprintf(stderr, "LAYER SETTING error: %u messages were dropped\n", dropped_count);
+    }
+}
+
+void SettingsLog::FreeSourceRepetitions(uint64_t source) {
+    for (auto it = this->delivered_messages.begin(); it != this->delivered_messages.end();) {
+        if (it->second.source != source) {
+            ++it;
+            continue;
+        }
+
+        this->ReportRepetition(it->first, it->second);
+
+        this->repetitions[it->first].count.store(0, std::memory_order_relaxed);
+        this->repetitions[it->first].key.store(0, std::memory_order_release);
+        it = this->delivered_messages.erase(it);
+    }
+}
+
+bool SettingsLog::HasRepetitionsToReport() const {
+    for (const auto &it : this->delivered_messages) {
+        if (this->repetitions[it.first].count.load(std::memory_order_relaxed) != it.second.reported_count) {
+            return true;
+        }
+    }
+    return this->dropped_count.load(std::memory_order_relaxed) > 0;
+}
+
+void SettingsLog::Run() {
+    auto report_time = std::chrono::steady_clock::now() + REPORT_INTERVAL;
+
+    for (;;) {
+        while (this->Drain()) {
+        }
+
+        uint64_t flush_request = 0;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (this->flush_request_count > this->flush_done_count) {
+                flush_request = this->flush_request_count;
+
+                // A message claimed before the flush is being written
+                if (this->dequeue_position.load(std::memory_order_relaxed) < this->flush_position) {
+                    std::this_thread::yield();
+                    continue;
+                }
+            }
+        }
+
+        // The sources released once their messages are delivered
+        std::vector<uint64_t> released;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            const uint64_t position = this->dequeue_position.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < this->released_sources.size();) {
+                if (this->released_sources[i].second > position) {
+                    ++i;
+                    continue;
+                }
+
+                try {
+                    released.push_back(this->released_sources[i].first);
+                } catch (const std::bad_alloc &) {
+                    break;
+                }
+                this->released_sources[i] = this->released_sources.back();
+                this->released_sources.pop_back();
+            }
+        }
+        for (uint64_t source : released) {
+            this->FreeSourceRepetitions(source);
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (flush_request != 0 || now >= report_time) {
+            this->ReportRepetitions();
+            report_time = now + REPORT_INTERVAL;
+        }
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+        if (flush_request != 0) {
+            this->flush_done_count = flush_request;
+            this->flushed_condition.notify_all();
+        }
+
+        if (this->stopping) {
+            return;
+        }
+
+        this->drain_sleeping.store(true, std::memory_order_relaxed);
+        this->drain_idle.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        const uint64_t position = this->dequeue_position.load(std::memory_order_relaxed);
+        const bool pending = this->slots[position % RING_CAPACITY].sequence.load(std::memory_order_acquire) == position + 1;
+        if (!pending && this->flush_request_count == this->flush_done_count) {
+            if (this->released_sources.empty() && !this->HasRepetitionsToReport()) {
+                // Woken up by the next message, repetition, flush or stop
+                this->wake_condition.wait_until(lock, NO_DEADLINE);
+                report_time = std::chrono::steady_clock::now() + REPORT_INTERVAL;
+            } else {
+                this->drain_idle.store(false, std::memory_order_relaxed);
+                this->wake_condition.wait_until(lock, report_time);
+            }
+        }
+
+        this->drain_idle.store(false, std::memory_order_relaxed);
+        this->drain_sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace vl
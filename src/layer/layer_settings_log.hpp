@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#pragma once
+
+#include "vulkan/layer/vk_layer_settings.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vl {
+    // Messages of the layer settings, delivered to the log callbacks or to stderr by a background thread so that logging an
+    // error never blocks a query on the output. Pushing a message doesn't allocate, except for long setting names, and only
+    // locks to start the thread or to wake it up: the message is copied in a slot of a bounded ring buffer, and the
+    // repetitions of a message already pushed are only counted. The number of repetitions is reported periodically, by Flush
+    // and when the source of the message is released. The thread is started by the first message and sleeps without timeout
+    // while there is nothing to deliver or report.
+    class SettingsLog {
+      public:
+        // The log is never destroyed, as messages may be logged by the destructors of other static objects. Its thread, if
+        // started, is stopped at exit or when the library is unloaded, the later messages are delivered by the threads that log
+        // them.
+        static SettingsLog &Get();
+
+        // Return a new identifier of the source of messages, each LayerSettings has its own: the repetitions are counted per
+        // source, so that a message logged again by a new LayerSettings is delivered again
+        uint64_t NewSource() { return this->next_source.fetch_add(1, std::memory_order_relaxed); }
+
+        // Report the repetitions of the messages of a source and free their entries of the repetition table once the messages
+        // pushed before the call are delivered. The source must not push messages afterward. Doesn't block.
+        void ReleaseSource(uint64_t source);
+
+        // Thread-safe. The message is truncated to the size of a slot, the setting name is not.
+        void Push(uint64_t source, VL_LAYER_SETTING_LOG_CALLBACK callback, const char *pSettingName, const char *pMessage);
+
+        // Wait until the messages pushed before the call are delivered, then report the repetitions counted since the last report
+        void Flush();
+
+        // Flush and join the thread, the messages pushed afterward are delivered by the threads that push them
+        void Stop();
+
+        // Size of the ring buffer, once it is full the new messages are dropped and their number reported
+        static const std::size_t RING_CAPACITY = 256;
+        // Number of messages which repetitions are counted, the repetitions of the messages that don't fit are delivered
+        static const std::size_t REPETITION_CAPACITY = 1024;
+
+        static const std::size_t SETTING_NAME_SIZE = 64;
+        static const std::size_t MESSAGE_SIZE = 448;
+
+      private:
+        SettingsLog();
+
+        enum ThreadState : uint32_t { THREAD_NOT_STARTED, THREAD_RUNNING, THREAD_STOPPED };
+
+        struct Slot {
+            std::atomic<uint64_t> sequence{0};
+            uint64_t source;
+            VL_LAYER_SETTING_LOG_CALLBACK callback;
+            bool repeated;                 // Counted as a repetition once the slot was claimed, not delivered
+            std::size_t repetition_index;  // REPETITION_CAPACITY when the repetitions of the message are not counted
+            char setting_name[SETTING_NAME_SIZE];
+            std::string long_setting_name;  // Used instead of 'setting_name' for the names that don't fit it
+            char message[MESSAGE_SIZE];
+        };
+
+        struct Repetition {
+            std::atomic<uint64_t> key{0};  // 0 when the entry is free
+            std::atomic<uint32_t> count{0};
+        };
+
+        // Message delivered by the drain thread which repetitions are counted
+        struct DeliveredMessage {
+            uint64_t source;
+            VL_LAYER_SETTING_LOG_CALLBACK callback;
+            std::string setting_name;
+            std::string message;
+            uint32_t reported_count;
+        };
+
+        static void Deliver(VL_LAYER_SETTING_LOG_CALLBACK callback, const char *pSettingName, const char *pMessage);
+
+        void StartThread();
+        void WakeThread();
+        void Run();
+
+        // Count a repetition of the message of 'key' if its entry is in the repetition table
+        bool CountRepetition(uint64_t key);
+        // Return REPETITION_CAPACITY if the repetitions of the message of 'key' can't be counted, or if they are counted in an
+        // entry claimed concurrently, in which case 'repeated' is set
+        std::size_t ClaimRepetition(uint64_t key, bool &repeated);
+
+        // Deliver the messages of the filled slots, return false if there are none. Only called by the drain thread.
+        bool Drain();
+        void ReportRepetition(std::size_t repetition_index, DeliveredMessage &delivered_message);
+        void ReportRepetitions();
+        void FreeSourceRepetitions(uint64_t source);
+        bool HasRepetitionsToReport() const;
+
+        Slot slots[RING_CAPACITY];
+        std::atomic<uint64_t> enqueue_position{0};
+        std::atomic<uint64_t> dequeue_position{0};  // Only written by the drain thread
+        std::atomic<uint32_t> dropped_count{0};
+
+        Repetition repetitions[REPETITION_CAPACITY];
+        std::unordered_map<std::size_t, DeliveredMessage> delivered_messages;  // Indexed by repetition index, drain thread only
+
+        std::atomic<uint64_t> next_source{1};
+
+        std::thread thread;                         // Written under 'mutex' before 'thread_state' is THREAD_RUNNING
+        std::atomic<uint32_t> thread_state{THREAD_NOT_STARTED};
+        std::mutex mutex;
+        std::condition_variable wake_condition;     // Wakes the drain thread up
+        std::condition_variable flushed_condition;  // Signaled each time the drain thread reported the repetitions
+        std::atomic<bool> drain_sleeping{false};
+        std::atomic<bool> drain_idle{false};        // Set while the drain thread sleeps without timeout
+        uint64_t flush_position{0};                 // Enqueue position when Flush was last called, under 'mutex'
+        uint64_t flush_request_count{0};            // Number of Flush calls, under 'mutex'
+        uint64_t flush_done_count{0};               // Number of Flush calls completed by the drain thread, under 'mutex'
+        bool stopping{false};                       // Set by Stop, under 'mutex'
+        // Released sources and the enqueue position when they were released, under 'mutex'
+        std::vector<std::pair<uint64_t, uint64_t>> released_sources;
+        std::mutex synchronous_mutex;               // Used to deliver the messages when the drain thread is not running
+    };
+} // namespace vl
@@ -20,61 +20,24 @@
 
 #include "layer_settings_manager.hpp"
 #include "layer_settings_util.hpp"
+#include "layer_settings_log.hpp"
 
 #include <sys/stat.h>
 
 #if defined(_WIN32)
 #include <windows.h>
-#include <direct.h>
-#define GetCurrentDir _getcwd
-#else
-#include <unistd.h>
-#define GetCurrentDir getcwd
-#endif
-
-#ifdef __ANDROID__
-#include <sys/system_properties.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <cstdlib>
 #include <cstring>
-#include <fstream>
 #include <sstream>
 #include <array>
-
-#if defined(__ANDROID__)
-static std::string GetAndroidProperty(const char *name) {
-    std::string output;
-    const prop_info *pi = __system_property_find(name);
-    if (pi) {
-        __system_property_read_callback(
-            pi,
-            [](void *cookie, const char *name, const char *value, uint32_t serial) {
-                reinterpret_cast<std::string *>(cookie)->assign(value);
-            },
-            reinterpret_cast<void *>(&output));
-    }
-    return output;
-}
-#endif
-
-static bool IsEnvironment(const char *variable) {
-#if defined(__ANDROID__)
-    return !GetAndroidProperty(variable).empty();
-#else
-    return std::getenv(variable) != NULL;
-#endif
-}
-
-static std::string GetEnvironment(const char *variable) {
-#if defined(__ANDROID__)
-    return GetAndroidProperty(variable);
-#else
-    const char *output = std::getenv(variable);
-    return output == NULL ? "" : output;
-#endif
-}
+#include <iterator>
+#include <atomic>
+#include <new>
 
 #if defined(WIN32)
 // Check for admin rights
@@ -103,36 +66,143 @@ static inline bool IsHighIntegrity() {
 
 namespace vl {
 
-LayerSettings::LayerSettings(const char *pLayerName, const VkInstanceCreateInfo *pCreateInfo, VL_LAYER_SETTING_LOG_CALLBACK callback)
-    : layer_name(pLayerName), create_info(FindSettingsInChain(pCreateInfo)), callback(callback) {
+LayerSettings::LayerSettings(const char *pLayerName, const VkInstanceCreateInfo *pCreateInfo,
+                             const VkAllocationCallbacks *pAllocator, VL_LAYER_SETTING_LOG_CALLBACK callback,
+                             std::shared_ptr<const EnvironmentSnapshot> environment, bool copy_api_settings)
+    : arena(pAllocator),
+      environment(std::move(environment)),
+      layer_name(this->arena.CopyString(pLayerName)),
+      file_setting_prefix(this->arena.CopyString(vl::GetFileSettingName(pLayerName, ""))),
+      create_info(FindSettingsInChain(pCreateInfo)),
+      copy_api_settings(copy_api_settings),
+      callback(callback),
+      log_source(vl::SettingsLog::Get().NewSource()) {
     assert(pLayerName != nullptr);
 
-    std::string settings_file = this->FindSettingsFile();
-    this->ParseSettingsFile(settings_file.c_str());
+    if (copy_api_settings) {
+        this->create_info = CopyLayerSettingsCreateInfo(this->arena, this->layer_name, this->create_info);
+    }
+
+    this->settings_filename = this->arena.CopyString(this->FindSettingsFile());
+    this->Build();
 }
 
-LayerSettings::~LayerSettings() {}
+LayerSettings::LayerSettings(std::string_view layer_name, const VkLayerSettingsCreateInfoEXT *create_info,
+                             const VkAllocationCallbacks *pAllocator, VL_LAYER_SETTING_LOG_CALLBACK callback,
+                             std::shared_ptr<const EnvironmentSnapshot> environment)
+    : arena(pAllocator),
+      environment(std::move(environment)),
+      layer_name(this->arena.CopyString(layer_name)),
+      file_setting_prefix(this->arena.CopyString(vl::GetFileSettingName(this->layer_name.data(), ""))),
+      create_info(nullptr),
+      copy_api_settings(true),
+      callback(callback),
+      log_source(vl::SettingsLog::Get().NewSource()) {
+    // 'create_info' is in the arena of the reloaded settings, which may be freed before these ones
+    this->create_info = CopyLayerSettingsCreateInfo(this->arena, this->layer_name, create_info);
+
+    // The settings file is found again, for example when a settings file of higher precedence was created
+    this->settings_filename = this->arena.CopyString(this->FindSettingsFile());
+    this->Build();
+}
 
-void LayerSettings::ParseSettingsFile(const char *filename) {
-    // Extract option = value pairs from a file
-    std::ifstream file(filename);
-    if (file.good()) {
-        for (std::string line; std::getline(file, line);) {
-            // discard comments, which start with '#'
-            const auto comments_pos = line.find_first_of('#');
-            if (comments_pos != std::string::npos) line.erase(comments_pos);
+LayerSettings::~LayerSettings() {
+    // Free the entries of the repetition table used by the messages of these layer settings
+    vl::SettingsLog::Get().ReleaseSource(this->log_source);
+}
 
-            const auto value_pos = line.find_first_of('=');
-            if (value_pos != std::string::npos) {
-                const std::string setting_key = vl::TrimWhitespace(line.substr(0, value_pos));
-                const std::string setting_value = vl::TrimWhitespace(line.substr(value_pos + 1));
-                this->setting_file_values[setting_key] = setting_value;
-            }
+// The allocation callbacks of a LayerSettings are stored before it, at an offset which keeps it aligned for any type
+struct LayerSettingsHeader {
+    VkAllocationCallbacks allocator;
+    bool has_allocator;
+};
+
+static const std::size_t LAYER_SETTINGS_HEADER_SIZE =
+    (sizeof(LayerSettingsHeader) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+void *LayerSettings::operator new(std::size_t size, const VkAllocationCallbacks *pAllocator) {
+    void *memory = vl::AllocateMemory(pAllocator, LAYER_SETTINGS_HEADER_SIZE + size);
+
+    LayerSettingsHeader *header = new (memory) LayerSettingsHeader{};
+    if (pAllocator != nullptr) {
+        header->allocator = *pAllocator;
+        header->has_allocator = true;
+    }
+
+    return static_cast<char *>(memory) + LAYER_SETTINGS_HEADER_SIZE;
+}
+
+void LayerSettings::operator delete(void *pointer, const VkAllocationCallbacks *) { LayerSettings::operator delete(pointer); }
+
+void LayerSettings::operator delete(void *pointer) {
+    if (pointer == nullptr) {
+        return;
+    }
+
+    void *memory = static_cast<char *>(pointer) - LAYER_SETTINGS_HEADER_SIZE;
+    const LayerSettingsHeader header = *static_cast<const LayerSettingsHeader *>(memory);
+    vl::FreeMemory(header.has_allocator ? &header.allocator : nullptr, memory);
+}
+
+std::unique_ptr<LayerSettings> LayerSettings::Reload() const {
+    assert(this->copy_api_settings);
+
+    const VkAllocationCallbacks *pAllocator = this->arena.GetAllocator();
+    return std::unique_ptr<LayerSettings>(
+        new (pAllocator) LayerSettings(this->layer_name, this->create_info, pAllocator, this->callback, this->environment));
+}
+
+void LayerSettings::Build() {
+    std::shared_ptr<const SettingsFile> file = vl::SettingsFile::Acquire(std::string(this->settings_filename), *this->environment);
+    this->settings_file = vl::SettingsFileView(std::move(file), this->file_setting_prefix);
+
+    this->BuildEnvSettings();
+    this->BuildAPISettings();
+    this->BuildEffectiveSettings();
+}
+
+#if !defined(WIN32)
+// Return the vk_layer_settings.txt file of VkConfig in the linux settings store, which may not exist
+static std::string GetHomeSettingsFile(const EnvironmentSnapshot &environment) {
+    std::string search_path(environment.Get("XDG_DATA_HOME"));
+    if (search_path == "") {
+        search_path = environment.Get("HOME");
+        if (search_path != "") {
+            search_path += "/.local/share";
         }
     }
+    return search_path != "" ? search_path + "/vulkan/settings.d/vk_layer_settings.txt" : "";
+}
+#endif
+
+// Return the settings file location overridden by an environment variable, an empty string if it is not set. 'exists' is set
+// when the path exists, a file or a directory.
+static std::string GetOverrideSettingsFile(const EnvironmentSnapshot &environment, bool &exists) {
+#ifdef __ANDROID__
+    std::string env_path(environment.Get("debug.vulkan.khronos_profiles.settings_path"));
+#else
+    std::string env_path(environment.Get("VK_LAYER_SETTINGS_PATH"));
+#endif
+
+    struct stat info;
+    exists = env_path != "" && stat(env_path.c_str(), &info) == 0;
+
+    // If this is a directory, append settings file name
+    if (exists && (info.st_mode & S_IFDIR)) {
+        env_path.append("/vk_layer_settings.txt");
+    }
+    return env_path;
 }
 
-std::string LayerSettings::FindSettingsFile() {
+// Return the settings file of the current working directory, used when no other settings file is found
+static std::string GetDefaultSettingsFile(const EnvironmentSnapshot &environment) {
+    if (environment.GetWorkingDirectory() != "") {
+        return environment.GetWorkingDirectory() + "/vk_layer_settings.txt";
+    }
+    return "vk_layer_settings.txt";
+}
+
+std::string LayerSettings::FindSettingsFile() const {
     struct stat info;
 
 #if defined(WIN32)
@@ -168,17 +238,9 @@ std::string LayerSettings::FindSettingsFile() {
         }
     }
 #else
-    // Look for VkConfig-specific settings location specified in a specific spot in the linux settings store
-    std::string search_path = GetEnvironment("XDG_DATA_HOME");
-    if (search_path == "") {
-        search_path = GetEnvironment("HOME");
-        if (search_path != "") {
-            search_path += "/.local/share";
-        }
-    }
-    // Use the vk_layer_settings.txt file from here, if it is present
-    if (search_path != "") {
-        std::string home_file = search_path + "/vulkan/settings.d/vk_layer_settings.txt";
+    // Use the vk_layer_settings.txt file of the linux settings store, if it is present
+    const std::string home_file = GetHomeSettingsFile(*this->environment);
+    if (home_file != "") {
         if (stat(home_file.c_str(), &info) == 0) {
             if (info.st_mode & S_IFREG) {
                 return home_file;
@@ -187,94 +249,425 @@ std::string LayerSettings::FindSettingsFile() {
     }
 #endif
 
-#ifdef __ANDROID__
-    std::string env_path = GetEnvironment("debug.vulkan.khronos_profiles.settings_path");
+    // If the path exists use it, else use vk_layer_settings
+    bool env_path_exists = false;
+    std::string env_path = GetOverrideSettingsFile(*this->environment, env_path_exists);
+    if (env_path_exists) {
+        return env_path;
+    }
+
+    return GetDefaultSettingsFile(*this->environment);
+}
+
+std::vector<std::string> LayerSettings::GetSettingsFileCandidates() const {
+    std::vector<std::string> candidates{std::string(this->settings_filename)};
+    auto add_candidate = [&candidates](std::string filename) {
+        if (filename != "" && std::find(candidates.begin(), candidates.end(), filename) == candidates.end()) {
+            candidates.push_back(std::move(filename));
+        }
+    };
+
+#if !defined(WIN32)
+    add_candidate(GetHomeSettingsFile(*this->environment));
+#endif
+    bool env_path_exists = false;
+    add_candidate(GetOverrideSettingsFile(*this->environment, env_path_exists));
+    add_candidate(GetDefaultSettingsFile(*this->environment));
+    return candidates;
+}
+
+std::size_t LayerSettings::EnvSettingNameHash::operator()(std::string_view name) const {
+    // FNV-1a
+    std::size_t hash = static_cast<std::size_t>(14695981039346656037ull);
+    for (char c : name) {
+#if !defined(__ANDROID__)
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+#endif
+        hash = (hash ^ static_cast<unsigned char>(c)) * static_cast<std::size_t>(1099511628211ull);
+    }
+    return hash;
+}
+
+bool LayerSettings::EnvSettingNameEqual::operator()(std::string_view a, std::string_view b) const {
+#if defined(__ANDROID__)
+    return a == b;
 #else
-    // Look for an environment variable override for the settings file location
-    std::string env_path = GetEnvironment("VK_LAYER_SETTINGS_PATH");
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::toupper(static_cast<unsigned char>(x)) == std::toupper(static_cast<unsigned char>(y));
+           });
 #endif
+}
 
-    // If the path exists use it, else use vk_layer_settings
-    if (stat(env_path.c_str(), &info) == 0) {
-        // If this is a directory, append settings file name
-        if (info.st_mode & S_IFDIR) {
-            env_path.append("/vk_layer_settings.txt");
+void LayerSettings::BuildEnvSettings() {
+    this->env_setting_index.clear();
+    this->env_settings.clear();
+
+    // Variable name prefixes, by order of precedence
+    const std::array<std::string, 2> prefixes = {
+        vl::GetEnvSettingName(this->layer_name.data(), "", vl::TRIM_NONE),
+        vl::GetEnvSettingName(this->layer_name.data(), "", vl::TRIM_VENDOR)};
+
+    struct Match {
+        std::size_t prefix_index;
+        std::string name;
+        std::string value;
+    };
+    std::vector<Match> matches;
+
+    for (const auto &environment_variable : this->environment->GetVariables()) {
+        const std::string &variable = environment_variable.first;
+        const std::string &value = environment_variable.second;
+#if defined(_WIN32)
+        // Windows environment variable names are case-insensitive
+        const std::string variable_name = vl::ToUpper(variable);
+#else
+        const std::string_view variable_name = variable;
+#endif
+        for (std::size_t i = 0, n = prefixes.size(); i < n; ++i) {
+            if (variable_name.size() <= prefixes[i].size() || variable_name.compare(0, prefixes[i].size(), prefixes[i]) != 0) {
+                continue;
+            }
+
+            std::string setting_name(variable_name.substr(prefixes[i].size()));
+#if !defined(__ANDROID__) && !defined(_WIN32)
+            // Setting names are upper cased to build the variable name so no setting matches lower case characters
+            if (setting_name != vl::ToUpper(setting_name)) {
+                continue;
+            }
+#endif
+            matches.push_back({i, std::move(setting_name), value});
         }
-        return env_path;
     }
 
-    // Default -- use the current working directory for the settings file location
-    char buff[512];
-    auto buf_ptr = GetCurrentDir(buff, 512);
-    if (buf_ptr) {
-        std::string location = buf_ptr;
-        location.append("/vk_layer_settings.txt");
-        return location;
+    std::stable_sort(matches.begin(), matches.end(), [](const Match &a, const Match &b) {
+        return a.name != b.name ? a.name < b.name : a.prefix_index < b.prefix_index;
+    });
+
+    // Use the first non-empty value by order of precedence
+    this->env_settings.reserve(matches.size());
+    for (std::size_t i = 0, n = matches.size(); i < n; ++i) {
+        if (!this->env_settings.empty() && this->env_settings.back().name == matches[i].name) {
+            if (this->env_settings.back().value.empty()) {
+                this->env_settings.back().value = this->arena.CopyString(matches[i].value);
+            }
+            continue;
+        }
+
+        this->env_settings.push_back({this->arena.CopyString(matches[i].name), this->arena.CopyString(matches[i].value)});
+    }
+
+    this->env_setting_index.reserve(this->env_settings.size());
+    for (std::size_t i = 0, n = this->env_settings.size(); i < n; ++i) {
+        this->env_setting_index.emplace(this->env_settings[i].name, i);
     }
-    return "vk_layer_settings.txt";
 }
 
-const VkLayerSettingEXT *LayerSettings::FindLayerSettingValue(const char *pSettingName) {
-    if (this->create_info == nullptr) {
+const EnvSetting *LayerSettings::FindEnvSetting(const char *pSettingName) const {
+    auto it = this->env_setting_index.find(std::string_view(pSettingName));
+    if (it == this->env_setting_index.end()) {
         return nullptr;
     }
 
-    const std::string setting_name(pSettingName);
+    return &this->env_settings[it->second];
+}
+
+static std::size_t GetSettingValueSize(VkLayerSettingTypeEXT type) {
+    switch (type) {
+        default:
+        case VK_LAYER_SETTING_TYPE_BOOL_EXT:
+            return sizeof(VkBool32);
+        case VK_LAYER_SETTING_TYPE_INT32_EXT:
+            return sizeof(int32_t);
+        case VK_LAYER_SETTING_TYPE_INT64_EXT:
+            return sizeof(int64_t);
+        case VK_LAYER_SETTING_TYPE_UINT32_EXT:
+            return sizeof(uint32_t);
+        case VK_LAYER_SETTING_TYPE_UINT64_EXT:
+            return sizeof(uint64_t);
+        case VK_LAYER_SETTING_TYPE_FLOAT_EXT:
+            return sizeof(float);
+        case VK_LAYER_SETTING_TYPE_DOUBLE_EXT:
+            return sizeof(double);
+        case VK_LAYER_SETTING_TYPE_FRAMESET_EXT:
+            return sizeof(VkFrameset);
+        case VK_LAYER_SETTING_TYPE_STRING_EXT:
+            return sizeof(const char *);
+    }
+}
+
+const VkLayerSettingsCreateInfoEXT *CopyLayerSettingsCreateInfo(Arena &arena, std::string_view layer_name,
+                                                                const VkLayerSettingsCreateInfoEXT *create_info) {
+    if (create_info == nullptr) {
+        return nullptr;
+    }
+
+    // Null terminated, as the layer name of the settings
+    const std::string_view layer_name_copy = arena.CopyString(layer_name);
+
+    // Only the settings of this layer are copied, in order, so that the first occurrence of a setting is still used
+    uint32_t setting_count = 0;
+    for (uint32_t i = 0; i < create_info->settingCount; ++i) {
+        const VkLayerSettingEXT &setting = create_info->pSettings[i];
+        if (setting.pLayerName != nullptr && setting.pSettingName != nullptr && layer_name == setting.pLayerName) {
+            ++setting_count;
+        }
+    }
+
+    VkLayerSettingEXT *settings = static_cast<VkLayerSettingEXT *>(
+        arena.Allocate(setting_count * sizeof(VkLayerSettingEXT), alignof(VkLayerSettingEXT)));
+
+    uint32_t setting_index = 0;
+    for (uint32_t i = 0; i < create_info->settingCount; ++i) {
+        const VkLayerSettingEXT &setting = create_info->pSettings[i];
+        if (setting.pLayerName == nullptr || setting.pSettingName == nullptr || layer_name != setting.pLayerName) {
+            continue;
+        }
+
+        const std::size_t size = setting.count * GetSettingValueSize(setting.type);
+        void *values = arena.Allocate(size, alignof(std::max_align_t));
+        if (size > 0 && setting.value != nullptr) {
+            std::memcpy(values, setting.value, size);
+        }
+
+        // The strings are copied, not only the pointers to them
+        if (setting.type == VK_LAYER_SETTING_TYPE_STRING_EXT && setting.value != nullptr) {
+            const char **strings = static_cast<const char **>(values);
+            for (uint32_t value_index = 0; value_index < setting.count; ++value_index) {
+                if (strings[value_index] != nullptr) {
+                    strings[value_index] = arena.CopyString(strings[value_index]).data();
+                }
+            }
+        }
+
+        VkLayerSettingEXT &copy = settings[setting_index++];
+        copy.pLayerName = layer_name_copy.data();
+        copy.pSettingName = arena.CopyString(setting.pSettingName).data();
+        copy.type = setting.type;
+        copy.count = setting.count;
+        copy.value = setting.value != nullptr ? values : nullptr;
+    }
+
+    VkLayerSettingsCreateInfoEXT *copy = arena.New<VkLayerSettingsCreateInfoEXT>();
+    copy->sType = VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT;
+    copy->pNext = nullptr;
+    copy->settingCount = setting_count;
+    copy->pSettings = settings;
+    return copy;
+}
+
+void LayerSettings::BuildAPISettings() {
+    this->api_settings.clear();
+
+    if (this->create_info == nullptr) {
+        return;
+    }
+
+    this->api_settings.reserve(this->create_info->settingCount);
 
     for (std::size_t i = 0, n = this->create_info->settingCount; i < n; ++i) {
         const VkLayerSettingEXT *setting = &this->create_info->pSettings[i];
-        if (setting->pLayerName != this->layer_name) {
+        if (setting->pLayerName == nullptr || setting->pSettingName == nullptr) {
             continue;
         }
 
-        if (setting->pSettingName != setting_name) {
+        if (this->layer_name != setting->pLayerName) {
             continue;
         }
 
-        return setting;
+        // When a setting is listed multiple times, the first occurrence is used
+        this->api_settings.emplace(setting->pSettingName, setting);
+    }
+}
+
+const VkLayerSettingEXT *LayerSettings::FindLayerSettingValue(const char *pSettingName) const {
+    auto it = this->api_settings.find(std::string_view(pSettingName));
+    if (it == this->api_settings.end()) {
+        return nullptr;
     }
 
-    return nullptr;
+    return it->second;
 }
 
-void LayerSettings::Log(const char *pSettingName, const char * pMessage) {
-    this->last_log_setting = pSettingName;
-    this->last_log_message = pMessage;
+void LayerSettings::BuildEffectiveSettings() {
+    this->effective_setting_handles.clear();
+    this->effective_settings.clear();
 
-    if (this->callback == nullptr) {
-        fprintf(stderr, "LAYER SETTING (%s) error: %s\n", this->last_log_setting.c_str(), this->last_log_message.c_str());
-    } else {
-        this->callback(this->last_log_setting.c_str(), this->last_log_message.c_str());
+    // Upper bound of the number of settings, so that the index is not rehashed
+    const std::size_t file_setting_count = this->settings_file.size();
+    this->effective_setting_handles.reserve(file_setting_count + this->api_settings.size() + this->env_settings.size());
+
+    // Settings from vk_layer_settings.txt that belong to this layer
+    const std::string_view file_prefix = this->file_setting_prefix;
+    for (const auto &file_setting : this->settings_file) {
+        this->ResolveEffectiveSetting(file_setting.first.substr(file_prefix.size()));
+    }
+
+    // Settings from VK_EXT_layer_settings that belong to this layer
+    for (const auto &api_setting : this->api_settings) {
+        this->ResolveEffectiveSetting(api_setting.first);
+    }
+
+    // Settings from environment variables, which setting names are upper cased
+    for (const EnvSetting &env_setting : this->env_settings) {
+#if defined(__ANDROID__)
+        this->ResolveEffectiveSetting(env_setting.name);
+#else
+        this->ResolveEffectiveSetting(vl::ToLower(std::string(env_setting.name)));
+#endif
     }
 }
 
-std::vector<std::string> &LayerSettings::GetSettingCache(const std::string &settingName) {
-    if (this->string_setting_cache.find(settingName) != this->string_setting_cache.end()) {
-        this->string_setting_cache.insert(
-            std::pair<std::string, std::vector<std::string>>(settingName, std::vector<std::string>()));
+uint64_t LayerSettings::NewHandleTag() {
+    static std::atomic<uint32_t> next_handle_tag{1};
+
+    // 0 is skipped so that no handle is null
+    uint32_t tag = next_handle_tag.fetch_add(1, std::memory_order_relaxed);
+    while (tag == 0) {
+        tag = next_handle_tag.fetch_add(1, std::memory_order_relaxed);
     }
+    return static_cast<uint64_t>(tag) << 32;
+}
 
-    return this->string_setting_cache[settingName];
+VlLayerSettingHandle LayerSettings::MakeHandle(std::size_t index) const {
+    return this->handle_tag | static_cast<VlLayerSettingHandle>(index + 1);
 }
 
-bool LayerSettings::HasEnvSetting(const char *pSettingName) {
+VlLayerSettingHandle LayerSettings::ResolveEffectiveSetting(std::string_view setting_name) {
+    VlLayerSettingHandle handle = VL_NULL_LAYER_SETTING_HANDLE;
+
+    auto it = this->effective_setting_handles.find(setting_name);
+    if (it != this->effective_setting_handles.end()) {
+        handle = it->second;
+    } else {
+        this->effective_settings.emplace_back();
+        this->effective_settings.back().name = this->arena.CopyString(setting_name);
+
+        handle = this->MakeHandle(this->effective_settings.size() - 1);
+        this->effective_setting_handles.insert({this->effective_settings.back().name, handle});
+    }
+
+    this->ResolveEffectiveSettingValues(this->effective_settings[(handle & HANDLE_INDEX_MASK) - 1]);
+
+    return handle;
+}
+
+void LayerSettings::ResolveEffectiveSettingValues(EffectiveSetting &setting) {
+    const char *pSettingName = setting.name.data();
+
+    // Environment variables overrides the values set by vk_layer_settings.txt
+    const EnvSetting *env_setting = this->FindEnvSetting(pSettingName);
+    setting.values = env_setting != nullptr ? env_setting->value : std::string_view();
+    if (setting.values.empty()) {
+        setting.values = this->FindFileSettingValue(pSettingName);
+    }
+    setting.api_setting = reinterpret_cast<const LayerSetting *>(this->FindLayerSettingValue(pSettingName));
+    setting.cache.reset(this->arena.New<SettingCache>(this->arena));
+}
+
+VlLayerSettingHandle LayerSettings::FindEffectiveSettingHandle(const char *pSettingName) {
     assert(pSettingName != nullptr);
 
-    for (int i = TRIM_FIRST, n = TRIM_LAST; i < n; ++i) {
-        if (IsEnvironment(GetEnvSettingName(this->layer_name.c_str(), pSettingName, static_cast<TrimMode>(i)).c_str())) {
-            return true;
+    auto it = this->effective_setting_handles.find(std::string_view(pSettingName));
+    if (it != this->effective_setting_handles.end()) {
+        return it->second;
+    }
+
+    // Environment variables of settings queried with upper case characters are resolved on their first query
+    if (!this->HasEnvSetting(pSettingName)) {
+        return VL_NULL_LAYER_SETTING_HANDLE;
+    }
+
+    std::lock_guard<std::mutex> lock(this->late_setting_mutex);
+
+    auto late_it = this->late_setting_handles.find(std::string_view(pSettingName));
+    if (late_it != this->late_setting_handles.end()) {
+        return late_it->second;
+    }
+
+    // The previous tables remain valid for the readers that loaded them, until the arena is freed
+    const std::size_t late_setting_count = this->late_setting_count.load(std::memory_order_relaxed);
+    if (late_setting_count == this->late_setting_capacity) {
+        const std::size_t capacity = std::max<std::size_t>(16, this->late_setting_capacity * 2);
+        const EffectiveSetting **table =
+            static_cast<const EffectiveSetting **>(this->arena.Allocate(capacity * sizeof(*table), alignof(EffectiveSetting *)));
+        if (late_setting_count > 0) {
+            std::copy_n(this->late_setting_table.load(std::memory_order_relaxed), late_setting_count, table);
         }
+        this->late_setting_table.store(table, std::memory_order_release);
+        this->late_setting_capacity = capacity;
     }
 
-    return false;
+    this->late_settings.emplace_back();
+    EffectiveSetting &setting = this->late_settings.back();
+    const VlLayerSettingHandle handle = LATE_SETTING_HANDLE_BIT | this->MakeHandle(this->late_settings.size() - 1);
+
+    // A setting that failed to resolve is not kept, so that its handle is never returned
+    try {
+        setting.name = this->arena.CopyString(pSettingName);
+        this->ResolveEffectiveSettingValues(setting);
+        this->late_setting_handles.insert({setting.name, handle});
+    } catch (...) {
+        this->late_settings.pop_back();
+        throw;
+    }
+
+    this->late_setting_table.load(std::memory_order_relaxed)[late_setting_count] = &setting;
+    this->late_setting_count.store(late_setting_count + 1, std::memory_order_release);
+
+    return handle;
+}
+
+const EffectiveSetting *LayerSettings::FindEffectiveSetting(const char *pSettingName) {
+    return this->GetEffectiveSetting(this->FindEffectiveSettingHandle(pSettingName));
+}
+
+const EffectiveSetting *LayerSettings::GetEffectiveSetting(VlLayerSettingHandle handle) const {
+    if (handle == VL_NULL_LAYER_SETTING_HANDLE || this->IsForeignHandle(handle)) {
+        return nullptr;
+    }
+
+    if ((handle & LATE_SETTING_HANDLE_BIT) != 0) {
+        const VlLayerSettingHandle index = handle & HANDLE_INDEX_MASK & ~LATE_SETTING_HANDLE_BIT;
+
+        // The table loaded after the count holds at least as many entries
+        if (index == 0 || index > this->late_setting_count.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return this->late_setting_table.load(std::memory_order_acquire)[index - 1];
+    }
+
+    const VlLayerSettingHandle index = handle & HANDLE_INDEX_MASK;
+    if (index == 0 || index > this->effective_settings.size()) {
+        return nullptr;
+    }
+
+    return &this->effective_settings[index - 1];
+}
+
+void LayerSettings::Log(const char *pSettingName, const char * pMessage) {
+    vl::SettingsLog::Get().Push(this->log_source, this->callback, pSettingName, pMessage);
+}
+
+SettingCache &LayerSettings::GetSettingCache(VlLayerSettingHandle handle) const {
+    const EffectiveSetting *setting = this->GetEffectiveSetting(handle);
+    assert(setting != nullptr);
+
+    return *setting->cache;
+}
+
+bool LayerSettings::HasEnvSetting(const char *pSettingName) {
+    assert(pSettingName != nullptr);
+
+    return this->FindEnvSetting(pSettingName) != nullptr;
 }
 
 bool LayerSettings::HasFileSetting(const char *pSettingName) { 
     assert(pSettingName != nullptr);
 
-    std::string file_setting_name = vl::GetFileSettingName(this->layer_name.c_str(), pSettingName);
+    std::string file_setting_name = vl::GetFileSettingName(this->layer_name.data(), pSettingName);
 
-    return setting_file_values.find(file_setting_name) != setting_file_values.end();
+    std::string_view value;
+    return this->settings_file.Find(file_setting_name, value) || this->added_file_values.count(file_setting_name) != 0;
 }
 
 bool LayerSettings::HasAPISetting(const char *pSettingName) {
@@ -284,33 +677,40 @@ bool LayerSettings::HasAPISetting(const char *pSettingName) {
 }
 
 std::string LayerSettings::GetEnvSetting(const char *pSettingName) {
-    std::string result;
-
-    for (int i = TRIM_FIRST, n = TRIM_LAST; i < n; ++i) {
-        result = GetEnvironment(GetEnvSettingName(this->layer_name.c_str(), pSettingName, static_cast<TrimMode>(i)).c_str());
-        if (!result.empty()) {
-            break;
-        }
-    }
-
-    return result;
+    const EnvSetting *env_setting = this->FindEnvSetting(pSettingName);
+    return env_setting == nullptr ? "" : std::string(env_setting->value);
 }
 
 std::string LayerSettings::GetFileSetting(const char *pSettingName) {
-    const std::string file_setting_name = vl::GetFileSettingName(this->layer_name.c_str(), pSettingName);
+    return std::string(this->FindFileSettingValue(pSettingName));
+}
 
-    std::map<std::string, std::string>::const_iterator it;
-    if ((it = this->setting_file_values.find(file_setting_name)) == this->setting_file_values.end()) {
-        return "";
-    } else {
-        return it->second;
+std::string_view LayerSettings::FindFileSettingValue(const char *pSettingName) const {
+    const std::string file_setting_name = std::string(this->file_setting_prefix) + pSettingName;
+
+    std::string_view value;
+    if (this->settings_file.Find(file_setting_name, value)) {
+        return value;
     }
+
+    auto it = this->added_file_values.find(file_setting_name);
+    return it != this->added_file_values.end() ? it->second : std::string_view();
 }
 
 void LayerSettings::SetFileSetting(const char *pSettingName, const std::string &value) {
     assert(pSettingName != nullptr);
 
-    this->setting_file_values.insert({pSettingName, value});
+    // The settings file is shared with other LayerSettings, the setting is only added to these settings
+    std::string_view file_value;
+    if (!this->settings_file.Find(pSettingName, file_value) && this->added_file_values.count(pSettingName) == 0) {
+        this->added_file_values.emplace(this->arena.CopyString(pSettingName), this->arena.CopyString(value));
+    }
+
+    const std::string_view file_prefix = this->file_setting_prefix;
+    const std::string file_setting_name(pSettingName);
+    if (file_setting_name.compare(0, file_prefix.size(), file_prefix) == 0) {
+        this->ResolveEffectiveSetting(file_setting_name.substr(file_prefix.size()));
+    }
 }
 
 const LayerSetting *LayerSettings::GetAPISetting(const char *pSettingName) { 
@@ -21,10 +21,21 @@
 #pragma once
 
 #include "vulkan/layer/vk_layer_settings.h"
+#include "layer_settings_arena.hpp"
+#include "layer_settings_environment.hpp"
+#include "layer_settings_file.hpp"
+#include "layer_settings_frameset.hpp"
+#include "layer_settings_string_set.hpp"
 
 #include <string>
 #include <vector>
 #include <map>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
 
 namespace vl {
     struct LayerSetting {
@@ -45,11 +56,114 @@ namespace vl {
         };
     };
 
+    // Copy the VK_EXT_layer_settings values of a layer in 'arena', including the strings, so that they outlive the
+    // VkInstanceCreateInfo of the application. Return nullptr if 'create_info' is nullptr.
+    const VkLayerSettingsCreateInfoEXT *CopyLayerSettingsCreateInfo(Arena &arena, std::string_view layer_name,
+                                                                    const VkLayerSettingsCreateInfoEXT *create_info);
+
+    // Values of an environment variable or of vk_layer_settings.txt, parsed by the first query of each type. Each kind of
+    // values is built once, under 'mutex', and is read without synchronization afterward. The values are stored in the arena
+    // of the LayerSettings.
+    struct SettingCache {
+        explicit SettingCache(Arena &arena)
+            : asBool32(arena),
+              asInt32(arena),
+              asInt64(arena),
+              asUint32(arena),
+              asUint64(arena),
+              asFloat(arena),
+              asDouble(arena),
+              asFrameset(arena),
+              asString(arena),
+              asStringPointer(arena) {}
+
+        // 'ready' bits of the values compiled from the parsed values, after the VkLayerSettingTypeEXT bits
+        static const uint32_t FRAMESET_INDEX_READY = 1u << 16;
+        static const uint32_t STRING_SET_READY = 1u << 17;
+
+        static uint32_t GetTypeBit(VkLayerSettingTypeEXT type) { return 1u << type; }
+
+        // Call 'build' if no previous call built the values of 'bit'
+        template <typename Build>
+        void BuildOnce(uint32_t bit, Build build) {
+            if ((this->ready.load(std::memory_order_acquire) & bit) != 0) {
+                return;
+            }
+
+            std::lock_guard<std::recursive_mutex> lock(this->mutex);
+            if ((this->ready.load(std::memory_order_relaxed) & bit) == 0) {
+                build();
+                this->ready.fetch_or(bit, std::memory_order_release);
+            }
+        }
+
+        ArenaVector<VkBool32> asBool32;
+        ArenaVector<int32_t> asInt32;
+        ArenaVector<int64_t> asInt64;
+        ArenaVector<uint32_t> asUint32;
+        ArenaVector<uint64_t> asUint64;
+        ArenaVector<float> asFloat;
+        ArenaVector<double> asDouble;
+        ArenaVector<VkFrameset> asFrameset;
+        ArenaString asString;                       // The setting list, which delimiters are replaced by null terminators
+        ArenaVector<const char *> asStringPointer;  // Pointers to the values in 'asString'
+
+        ArenaPtr<FramesetIndex> frameset_index;  // Compiled by the first vlIsFrameInLayerSettingFrameset call
+        ArenaPtr<StringSet> string_set;          // Built by the first vlLayerSettingContains call
+        std::atomic<uint64_t> flags{0};                 // Resolved from the flags registered by vlRegisterLayerSettingFlags
+
+        std::atomic<uint32_t> ready{0};
+        std::recursive_mutex mutex;  // Recursive: the frameset index and the string set are built from the parsed values
+    };
+
+    // Values of a setting after resolving the precedence between the sources:
+    // environment variables, then vk_layer_settings.txt, then VK_EXT_layer_settings
+    struct EffectiveSetting {
+        std::string_view name;                     // Null terminated, in the arena of the LayerSettings
+        std::string_view values;                   // From the environment variable or vk_layer_settings.txt
+        const LayerSetting *api_setting{nullptr};  // From VK_EXT_layer_settings, used when 'values' is empty
+        ArenaPtr<SettingCache> cache;              // Filled by the queries of 'values'
+    };
+
+    // Environment variable of a setting, 'name' is the setting part of the variable name. Both are in the arena of the
+    // LayerSettings.
+    struct EnvSetting {
+        std::string_view name;
+        std::string_view value;
+    };
+
     class LayerSettings {
       public:
-        LayerSettings(const char *pLayerName, const VkInstanceCreateInfo *pCreateInfo, VL_LAYER_SETTING_LOG_CALLBACK callback);
+        // The settings are stored with 'pAllocator', which is copied. With 'copy_api_settings', the VK_EXT_layer_settings values
+        // of the layer are copied too, so that the settings can be reloaded after the application freed 'pCreateInfo'. The
+        // environment variables and the settings file are found in 'environment'.
+        LayerSettings(const char *pLayerName, const VkInstanceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator,
+                      VL_LAYER_SETTING_LOG_CALLBACK callback, std::shared_ptr<const EnvironmentSnapshot> environment,
+                      bool copy_api_settings = false);
         ~LayerSettings();
 
+        // LayerSettings are allocated with the allocation callbacks they are constructed with, for example
+        // new (pAllocator) LayerSettings(pLayerName, pCreateInfo, pAllocator, callback). The callbacks are kept with the
+        // allocation to free it.
+        static void *operator new(std::size_t size, const VkAllocationCallbacks *pAllocator);
+        static void operator delete(void *pointer, const VkAllocationCallbacks *pAllocator);
+        static void operator delete(void *pointer);
+
+        // Return the settings of the same layer, VK_EXT_layer_settings values, allocation callbacks, log callback and
+        // environment snapshot, with the settings file found and read again. The settings must have been constructed with
+        // 'copy_api_settings', the new settings copy the VK_EXT_layer_settings values too.
+        std::unique_ptr<LayerSettings> Reload() const;
+
+        // Path of vk_layer_settings.txt, which may not exist. Null terminated.
+        std::string_view GetSettingsFilename() const { return this->settings_filename; }
+
+        // The settings file, then the other files which creation, modification or removal may change the settings file found
+        // by Reload or its content
+        std::vector<std::string> GetSettingsFileCandidates() const;
+
+        // Storage of the values of these settings, allocated with their allocation callbacks
+        Arena &GetArena() { return this->arena; }
+
 	    bool HasEnvSetting(const char *pSettingName);
 
         bool HasFileSetting(const char *pSettingName);
@@ -66,23 +180,106 @@ namespace vl {
 
         void Log(const char *pSettingName, const char *pMessage);
 
-        std::vector<std::string> &GetSettingCache(const std::string &pSettingName);
+        SettingCache &GetSettingCache(VlLayerSettingHandle handle) const;
+
+        // Return VL_NULL_LAYER_SETTING_HANDLE when the setting is not set by any source. Thread-safe, locks to find the
+        // environment variables resolved on their first query.
+        VlLayerSettingHandle FindEffectiveSettingHandle(const char *pSettingName);
+
+        // Return nullptr when the setting is not set by any source
+        const EffectiveSetting *FindEffectiveSetting(const char *pSettingName);
+
+        // Return nullptr when the handle is null or was returned by other settings. Doesn't lock.
+        const EffectiveSetting *GetEffectiveSetting(VlLayerSettingHandle handle) const;
+
+        // Check whether a handle was returned by other settings, for example by the settings replaced by a reload
+        bool IsForeignHandle(VlLayerSettingHandle handle) const {
+            return handle != VL_NULL_LAYER_SETTING_HANDLE && (handle & ~HANDLE_INDEX_MASK) != this->handle_tag;
+        }
+
+        // Bytes allocated for these settings, except the values of vk_layer_settings.txt shared with other LayerSettings.
+        // Thread-safe.
+        std::size_t GetMemoryUsage() const { return sizeof(*this) + this->arena.GetSize(); }
 
       private:
-        const VkLayerSettingEXT *FindLayerSettingValue(const char *pSettingName);
+        static const VlLayerSettingHandle HANDLE_INDEX_MASK = 0xFFFFFFFFu;
+
+        LayerSettings(std::string_view layer_name, const VkLayerSettingsCreateInfoEXT *create_info,
+                      const VkAllocationCallbacks *pAllocator, VL_LAYER_SETTING_LOG_CALLBACK callback,
+                      std::shared_ptr<const EnvironmentSnapshot> environment);
+
+        void Build();
+
+        const VkLayerSettingEXT *FindLayerSettingValue(const char *pSettingName) const;
+
+        const EnvSetting *FindEnvSetting(const char *pSettingName) const;
+        std::string_view FindFileSettingValue(const char *pSettingName) const;
+
+        void BuildEnvSettings();
+        void BuildAPISettings();
+        void BuildEffectiveSettings();
+        VlLayerSettingHandle ResolveEffectiveSetting(std::string_view setting_name);
+        void ResolveEffectiveSettingValues(EffectiveSetting &setting);
+
+        // The setting part of environment variable names is upper case, except for Android system properties
+        struct EnvSettingNameHash {
+            std::size_t operator()(std::string_view name) const;
+        };
+        struct EnvSettingNameEqual {
+            bool operator()(std::string_view a, std::string_view b) const;
+        };
+
+        // Storage of the strings, the values and the containers below, freed at once with the LayerSettings. Declared first
+        // so that it outlives them.
+        Arena arena;
+
+        // Shared with the reloaded settings, allocated with the global heap
+        std::shared_ptr<const EnvironmentSnapshot> environment;
+
+        // Environment variables of this layer, from 'environment'
+        ArenaVector<EnvSetting> env_settings{this->arena};
+        ArenaUnorderedMap<std::string_view, std::size_t, EnvSettingNameHash, EnvSettingNameEqual> env_setting_index{this->arena};
+
+        // Settings of this layer only, from vk_layer_settings.txt which parse is shared with the other LayerSettings
+        SettingsFileView settings_file;
+        // Settings added by SetFileSetting, used when not in 'settings_file'
+        ArenaMap<std::string_view, std::string_view> added_file_values{this->arena};
+
+        // VK_EXT_layer_settings values of this layer, indexed by setting name
+        ArenaUnorderedMap<std::string_view, const VkLayerSettingEXT *> api_settings{this->arena};
+        // Handles are 'handle_tag' in the upper 32 bits and an index + 1 in 'effective_settings' in the lower 32 bits. The deque
+        // keeps the settings referenced by handle stable.
+        ArenaDeque<EffectiveSetting> effective_settings{this->arena};
+        ArenaUnorderedMap<std::string_view, VlLayerSettingHandle> effective_setting_handles{this->arena};
 
-        std::map<std::string, std::string> setting_file_values;
-        std::map<std::string, std::vector<std::string>> string_setting_cache;
+        // Identifies the handles of these settings, unique to each LayerSettings of the process until it wraps around after
+        // 2^32 LayerSettings, so that the handles of other settings are rejected rather than resolved to another setting
+        static uint64_t NewHandleTag();
+        const uint64_t handle_tag{NewHandleTag()};
+        VlLayerSettingHandle MakeHandle(std::size_t index) const;
 
-        std::string last_log_setting;
-        std::string last_log_message;
+        // Environment variables of settings queried with upper case characters, resolved on their first query under
+        // 'late_setting_mutex'. Their handles have LATE_SETTING_HANDLE_BIT set and are resolved without locking, through a
+        // table of the settings in the arena replaced by a larger copy when it is full. The settings resolved by the
+        // constructor are read without synchronization.
+        static const VlLayerSettingHandle LATE_SETTING_HANDLE_BIT = 0x80000000u;
+        mutable std::mutex late_setting_mutex;
+        ArenaDeque<EffectiveSetting> late_settings{this->arena};
+        ArenaUnorderedMap<std::string_view, VlLayerSettingHandle> late_setting_handles{this->arena};
+        std::atomic<const EffectiveSetting **> late_setting_table{nullptr};
+        std::atomic<std::size_t> late_setting_count{0};  // Entries of 'late_setting_table' published to the readers
+        std::size_t late_setting_capacity{0};            // Under 'late_setting_mutex'
 
-        std::string FindSettingsFile();
-        void ParseSettingsFile(const char *filename);
+        std::string FindSettingsFile() const;
 
-        std::string layer_name;
-        const VkLayerSettingsCreateInfoEXT *create_info;
+        // Null terminated, in the arena
+        std::string_view layer_name;
+        std::string_view file_setting_prefix;  // Prefix of the vk_layer_settings.txt keys of this layer
+        std::string_view settings_filename;
+        const VkLayerSettingsCreateInfoEXT *create_info;  // In the arena with 'copy_api_settings'
+        bool copy_api_settings{false};
         VL_LAYER_SETTING_LOG_CALLBACK callback{nullptr};
+        uint64_t log_source;  // Identifies the messages of these settings in the SettingsLog
     };
 }// namespace vl
 
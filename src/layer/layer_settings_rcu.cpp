@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include "layer_settings_rcu.hpp"
+
+namespace vl {
+
+// A reader thread. The slots are never deleted: a slot is reused by another thread once its thread exits.
+struct RcuReaderSlot {
+    std::atomic<uint64_t> epoch{0};  // 0 outside of a read section, otherwise the epoch the read section was entered in
+    std::atomic<bool> in_use{false};
+    RcuReaderSlot *next{nullptr};
+};
+
+static std::atomic<uint64_t> rcu_epoch{1};
+static std::atomic<RcuReaderSlot *> rcu_reader_slots{nullptr};
+
+static RcuReaderSlot *AcquireReaderSlot() {
+    for (RcuReaderSlot *slot = rcu_reader_slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+        bool in_use = false;
+        if (!slot->in_use.load(std::memory_order_relaxed) && slot->in_use.compare_exchange_strong(in_use, true)) {
+            return slot;
+        }
+    }
+
+    RcuReaderSlot *slot = new RcuReaderSlot;
+    slot->in_use.store(true, std::memory_order_relaxed);
+    slot->next = rcu_reader_slots.load(std::memory_order_relaxed);
+    while (!rcu_reader_slots.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    return slot;
+}
+
+// The reader slot of the calling thread, released when the thread exits
+class RcuThreadReader {
+  public:
+    ~RcuThreadReader() {
+        if (this->slot != nullptr) {
+            this->slot->epoch.store(0, std::memory_order_release);
+            this->slot->in_use.store(false, std::memory_order_release);
+        }
+    }
+
+    RcuReaderSlot *slot{nullptr};
+};
+
+static thread_local RcuThreadReader rcu_thread_reader;
+
+// Nesting depth of the read sections of the calling thread. Trivially destructible, so that checking it doesn't construct the
+// reader of a thread which never reads.
+static thread_local uint32_t rcu_read_depth = 0;
+
+RcuReadGuard::RcuReadGuard() {
+    if (rcu_read_depth++ > 0) {
+        return;
+    }
+
+    RcuThreadReader &reader = rcu_thread_reader;
+    if (reader.slot == nullptr) {
+        reader.slot = AcquireReaderSlot();
+    }
+
+    // Sequentially consistent so that a writer either sees this reader or this reader loads the pointer published by the writer
+    reader.slot->epoch.store(rcu_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+}
+
+RcuReadGuard::~RcuReadGuard() {
+    if (--rcu_read_depth > 0) {
+        return;
+    }
+
+    rcu_thread_reader.slot->epoch.store(0, std::memory_order_release);
+}
+
+bool RcuIsInReadSection() { return rcu_read_depth > 0; }
+
+uint64_t RcuAdvanceEpoch() { return rcu_epoch.fetch_add(1, std::memory_order_seq_cst) + 1; }
+
+bool RcuIsQuiescent(uint64_t epoch) {
+    for (RcuReaderSlot *slot = rcu_reader_slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+        const uint64_t reader_epoch = slot->epoch.load(std::memory_order_seq_cst);
+        if (reader_epoch != 0 && reader_epoch < epoch) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace vl
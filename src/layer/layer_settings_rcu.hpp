@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vl {
+    // Mark the calling thread as reading objects published by RcuPointer until the guard is destroyed. Guards nest. Entering and
+    // leaving a read section is wait-free, except for the first read section of a thread which registers the thread.
+    class RcuReadGuard {
+      public:
+        RcuReadGuard();
+        ~RcuReadGuard();
+
+        RcuReadGuard(const RcuReadGuard &) = delete;
+        RcuReadGuard &operator=(const RcuReadGuard &) = delete;
+    };
+
+    // Start a new epoch and return it. Readers which entered their read section before the new epoch may still use the objects
+    // retired before it.
+    uint64_t RcuAdvanceEpoch();
+
+    // Check whether no reader is still in a read section entered before 'epoch'
+    bool RcuIsQuiescent(uint64_t epoch);
+
+    // Check whether the calling thread is in a read section
+    bool RcuIsInReadSection();
+
+    // An object published to readers through an atomic pointer. Publishing a new object retires the previous one, which is
+    // deleted once the readers that could have loaded it left their read section. Writers never block readers: Publish waits
+    // for these readers then deletes the retired objects, so that at most one object is alive once it returns. Publish called
+    // in a read section can't wait for itself, its retired object is deleted by a later Publish, by Reset or by the
+    // destructor.
+    template <typename T>
+    class RcuPointer {
+      public:
+        RcuPointer() = default;
+        ~RcuPointer() {
+            delete this->pointer.load();
+            for (auto &retired_object : this->retired) {
+                delete retired_object.second;
+            }
+        }
+
+        RcuPointer(const RcuPointer &) = delete;
+        RcuPointer &operator=(const RcuPointer &) = delete;
+
+        // Must be called in a read section, the object remains valid until the end of the read section
+        T *Load() const { return this->pointer.load(std::memory_order_seq_cst); }
+
+        void Publish(std::unique_ptr<T> object) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            T *previous = this->pointer.exchange(object.release(), std::memory_order_seq_cst);
+            if (previous != nullptr) {
+                this->retired.emplace_back(RcuAdvanceEpoch(), previous);
+            }
+
+            // The readers of the last retired object are the last readers of all of them
+            if (!this->retired.empty() && !RcuIsInReadSection()) {
+                while (!RcuIsQuiescent(this->retired.back().first)) {
+                    std::this_thread::yield();
+                }
+            }
+
+            // Delete the retired objects no reader can still use
+            std::size_t kept_count = 0;
+            for (std::size_t i = 0, n = this->retired.size(); i < n; ++i) {
+                if (RcuIsQuiescent(this->retired[i].first)) {
+                    delete this->retired[i].second;
+                } else {
+                    this->retired[kept_count++] = this->retired[i];
+                }
+            }
+            this->retired.resize(kept_count);
+        }
+
+        // Unpublish the object and delete it with the retired objects, waiting for the readers that could have loaded them. Must
+        // not be called in a read section.
+        void Reset() {
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            T *previous = this->pointer.exchange(nullptr, std::memory_order_seq_cst);
+            const uint64_t epoch = RcuAdvanceEpoch();
+            while (!RcuIsQuiescent(epoch)) {
+                std::this_thread::yield();
+            }
+
+            delete previous;
+            for (auto &retired_object : this->retired) {
+                delete retired_object.second;
+            }
+            this->retired.clear();
+        }
+
+      private:
+        std::atomic<T *> pointer{nullptr};
+        std::mutex mutex;                               // Serializes the writers
+        std::vector<std::pair<uint64_t, T *>> retired;  // Retired objects and the epoch they were retired in
+    };
+} // namespace vl
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include "layer_settings_string_set.hpp"
+
+namespace vl {
+
+// FNV-1a followed by a multiplicative mix, so that the high bits used by the bloom filter are well distributed too
+static uint64_t HashString(std::string_view value) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : value) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+    }
+    hash ^= hash >> 32;
+    return hash * 0x9e3779b97f4a7c15ull;
+}
+
+static uint64_t RoundUpToPowerOfTwo(uint64_t value) {
+    uint64_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+StringSet::StringSet(const char *const *pValues, std::size_t count, Arena *arena) : bloom(arena), slots(arena) {
+    if (count == 0) {
+        return;
+    }
+
+    // At most half of the slots are used, keeping the probe sequences short
+    this->slots.resize(RoundUpToPowerOfTwo(count * 2));
+    this->slot_mask = this->slots.size() - 1;
+
+    // 16 bits per value and two probes: about 1.4% of false positives
+    const uint64_t bloom_bit_count = RoundUpToPowerOfTwo(count * 16 < 64 ? 64 : count * 16);
+    this->bloom.resize(bloom_bit_count / 64);
+    this->bloom_mask = bloom_bit_count - 1;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (pValues[i] == nullptr) {
+            continue;
+        }
+
+        const std::string_view value(pValues[i]);
+        const uint64_t hash = HashString(value);
+
+        const uint64_t bit0 = hash & this->bloom_mask;
+        const uint64_t bit1 = (hash >> 32) & this->bloom_mask;
+        this->bloom[bit0 / 64] |= 1ull << (bit0 % 64);
+        this->bloom[bit1 / 64] |= 1ull << (bit1 % 64);
+
+        for (uint64_t index = hash & this->slot_mask;; index = (index + 1) & this->slot_mask) {
+            Slot &slot = this->slots[index];
+            if (slot.data == nullptr) {
+                slot = Slot{hash, value.data(), value.size()};
+                break;
+            }
+            if (slot.hash == hash && std::string_view(slot.data, slot.size) == value) {
+                break;  // Duplicated value
+            }
+        }
+    }
+}
+
+bool StringSet::Contains(std::string_view value) const {
+    if (this->slots.empty()) {
+        return false;
+    }
+
+    const uint64_t hash = HashString(value);
+
+    const uint64_t bit0 = hash & this->bloom_mask;
+    const uint64_t bit1 = (hash >> 32) & this->bloom_mask;
+    if ((this->bloom[bit0 / 64] & (1ull << (bit0 % 64))) == 0 || (this->bloom[bit1 / 64] & (1ull << (bit1 % 64))) == 0) {
+        return false;
+    }
+
+    for (uint64_t index = hash & this->slot_mask;; index = (index + 1) & this->slot_mask) {
+        const Slot &slot = this->slots[index];
+        if (slot.data == nullptr) {
+            return false;
+        }
+        if (slot.hash == hash && std::string_view(slot.data, slot.size) == value) {
+            return true;
+        }
+    }
+}
+
+}  // namespace vl
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#pragma once
+
+#include "layer_settings_arena.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace vl {
+    // Membership of the values of a string list setting, for example from a message ID filter list. The values are hashed once
+    // into an open addressing table, behind a bloom filter so that most queries of values not in the set don't probe the table.
+    // The values are referenced, not copied: they must outlive the set. The table is stored in 'arena', or in the global heap
+    // without arena.
+    class StringSet {
+      public:
+        StringSet() = default;
+        StringSet(const char *const *pValues, std::size_t count, Arena *arena = nullptr);
+
+        bool Contains(std::string_view value) const;
+
+      private:
+        struct Slot {
+            uint64_t hash;
+            const char *data;  // nullptr when the slot is empty
+            std::size_t size;
+        };
+
+        ArenaVector<uint64_t> bloom;
+        uint64_t bloom_mask{0};  // Number of bits of 'bloom' - 1
+        ArenaVector<Slot> slots;
+        uint64_t slot_mask{0};  // Number of 'slots' - 1
+    };
+} // namespace vl
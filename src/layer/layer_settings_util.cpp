@@ -19,9 +19,10 @@
  */
 
 #include "layer_settings_util.hpp"
+#include "layer_settings_convert.hpp"
 
+#include <algorithm>
 #include <sstream>
-#include <regex>
 #include <cstdlib>
 #include <cassert>
 
@@ -43,23 +44,39 @@ const VkLayerSettingsCreateInfoEXT *FindSettingsInChain(const void *next) {
 
 std::vector<std::string> Split(const std::string &value, char delimiter) {
     std::vector<std::string> result;
+    result.reserve(CountTokens(value, delimiter));
 
-    std::string parse = value;
+    Tokenizer tokenizer(value, delimiter);
+    for (std::string_view token; tokenizer.Next(token);) {
+        result.emplace_back(token);
+    }
 
-    std::size_t start = 0;
-    std::size_t end = parse.find(delimiter);
-    while (end != std::string::npos) {
-        result.push_back(parse.substr(start, end - start));
-        start = end + 1;
-        end = parse.find(delimiter, start);
+    return result;
+}
+
+bool Tokenizer::Next(std::string_view &token) {
+    if (this->position >= this->value.size()) {
+        return false;
     }
 
-    const std::string last = parse.substr(start, end);
-    if (!last.empty()) {
-        result.push_back(last);
+    std::size_t end = this->value.find(this->delimiter, this->position);
+    if (end == std::string_view::npos) {
+        end = this->value.size();
     }
 
-    return result;
+    token = this->value.substr(this->position, end - this->position);
+    this->position = end + 1;
+    return true;
+}
+
+std::size_t CountTokens(std::string_view value, char delimiter) {
+    if (value.empty()) {
+        return 0;
+    }
+
+    // Each delimiter ends a token, the last token is empty when 'value' ends with a delimiter
+    std::size_t count = static_cast<std::size_t>(std::count(value.begin(), value.end(), delimiter));
+    return value.back() == delimiter ? count : count + 1;
 }
 
 std::string GetFileSettingName(const char *pLayerName, const char *pSettingName) {
@@ -120,10 +137,10 @@ char GetEnvDelimiter() {
 #endif
 }
 
-char FindDelimiter(const std::string& s) {
-    if (s.find(',') != std::string::npos) {
+char FindDelimiter(std::string_view s) {
+    if (s.find(',') != std::string_view::npos) {
         return ',';
-    } else if (s.find(GetEnvDelimiter()) != std::string::npos) {
+    } else if (s.find(GetEnvDelimiter()) != std::string_view::npos) {
         return GetEnvDelimiter();
     } else {
         return ',';
@@ -183,53 +200,125 @@ std::string ToUpper(const std::string &s) {
     return result;
 }
 
-VkFrameset ToFrameSet(const std::string &s) {
+VkFrameset ToFrameSet(std::string_view s) {
     assert(IsFrameSets(s));
 
     VkFrameset frameset{0, 1, 1};
+    uint32_t *numbers[] = {&frameset.first, &frameset.count, &frameset.step};
 
-    const std::vector<std::string> &frameset_split = vl::Split(s, '-');
-    if (frameset_split.size() >= 1) {
-        frameset.first = static_cast<std::uint32_t>(std::atoll(frameset_split[0].c_str()));
-    }
-    if (frameset_split.size() >= 2) {
-        frameset.count = static_cast<std::uint32_t>(std::atoll(frameset_split[1].c_str()));
-    }
-    if (frameset_split.size() >= 3) {
-        frameset.step = static_cast<std::uint32_t>(std::atoll(frameset_split[2].c_str()));
+    Tokenizer tokenizer(s, '-');
+    std::string_view token;
+    for (uint32_t *number : numbers) {
+        if (!tokenizer.Next(token)) {
+            break;
+        }
+
+        uint64_t value = 0;
+        ConvertUint64(token, value);
+        *number = static_cast<uint32_t>(value);
     }
 
     return frameset;
 }
 
-std::vector<VkFrameset> ToFrameSets(const std::string &s) {
-    std::vector<std::string> tokens = Split(s, FindDelimiter(s));
+std::vector<VkFrameset> ToFrameSets(std::string_view s) {
+    const char delimiter = FindDelimiter(s);
 
     std::vector<VkFrameset> results;
-    results.resize(tokens.size());
-    for (std::size_t i = 0, n = tokens.size(); i < n; ++i) {
-        results[i] = ToFrameSet(tokens[i]);
+    results.reserve(CountTokens(s, delimiter));
+
+    Tokenizer tokenizer(s, delimiter);
+    for (std::string_view token; tokenizer.Next(token);) {
+        results.push_back(ToFrameSet(token));
     }
 
     return results;
 }
 
-bool IsFrameSets(const std::string &s) {
-    static const std::regex FRAME_REGEX("^([0-9]+([-][0-9]+){0,2})(,([0-9]+([-][0-9]+){0,2}))*$");
+static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+static bool IsAlphaNumeric(char c) { return IsDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+// Skip [0-9]* from 'i' and return the position of the first other character
+static std::size_t SkipDigits(std::string_view s, std::size_t i) {
+    while (i < s.size() && IsDigit(s[i])) {
+        ++i;
+    }
+    return i;
+}
+
+// Matches ^([0-9]+([-][0-9]+){0,2})(,([0-9]+([-][0-9]+){0,2}))*$
+bool IsFrameSets(std::string_view s) {
+    std::size_t i = 0;
+
+    while (true) {
+        // A frameset is made of one to three numbers separated by '-'
+        for (int number = 0; number < 3; ++number) {
+            const std::size_t end = SkipDigits(s, i);
+            if (end == i) {
+                return false;
+            }
+            i = end;
+
+            if (i == s.size() || s[i] != '-') {
+                break;
+            }
+            if (number == 2) {
+                return false;
+            }
+            ++i;
+        }
 
-    return std::regex_search(s, FRAME_REGEX);
+        if (i == s.size()) {
+            return true;
+        }
+        if (s[i] != ',') {
+            return false;
+        }
+        ++i;
+    }
 }
 
-bool IsInteger(const std::string &s) {
-    static const std::regex FRAME_REGEX("^-?([0-9]*|0x[0-9|a-z|A-Z]*)$");
+// Matches ^-?([0-9]*|0x[0-9|a-z|A-Z]*)$
+bool IsInteger(std::string_view s) {
+    std::size_t i = 0;
+    if (i < s.size() && s[i] == '-') {
+        ++i;
+    }
 
-    return std::regex_search(s, FRAME_REGEX);
+    if (s.size() - i >= 2 && s[i] == '0' && s[i + 1] == 'x') {
+        for (i += 2; i < s.size(); ++i) {
+            if (!IsAlphaNumeric(s[i]) && s[i] != '|') {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return SkipDigits(s, i) == s.size();
 }
 
-bool IsFloat(const std::string &s) {
-    static const std::regex FRAME_REGEX("^-?[0-9]*([.][0-9]*f?)?$");
+// Matches ^-?[0-9]*([.][0-9]*f?)?$
+bool IsFloat(std::string_view s) {
+    std::size_t i = 0;
+    if (i < s.size() && s[i] == '-') {
+        ++i;
+    }
+
+    i = SkipDigits(s, i);
+    if (i == s.size()) {
+        return true;
+    }
+    if (s[i] != '.') {
+        return false;
+    }
+
+    i = SkipDigits(s, i + 1);
+    if (i < s.size() && s[i] == 'f') {
+        ++i;
+    }
 
-    return std::regex_search(s, FRAME_REGEX);
+    return i == s.size();
 }
 
 std::string Format(const char *message, ...) {
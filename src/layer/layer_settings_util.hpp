@@ -24,6 +24,7 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <cstring>
 #include <cstdarg>
 
@@ -34,6 +35,23 @@ namespace vl {
     std::vector<std::string> Split(
         const std::string &value, char delimiter);
 
+    // Tokens of 'value' as views into 'value', without allocation. The tokens are the ones returned by Split:
+    // empty tokens are kept, except a trailing one.
+    class Tokenizer {
+      public:
+        Tokenizer(std::string_view value, char delimiter) : value(value), delimiter(delimiter) {}
+
+        // Return false when there are no more tokens
+        bool Next(std::string_view &token);
+
+      private:
+        std::string_view value;
+        char delimiter;
+        std::size_t position{0};
+    };
+
+    std::size_t CountTokens(std::string_view value, char delimiter);
+
     enum TrimMode {
         TRIM_NONE,
         TRIM_VENDOR,
@@ -48,7 +66,7 @@ namespace vl {
     std::string GetFileSettingName(const char *layer_key, const char *setting_key);
 
     // Find the delimiter (, ; :) in a string made of tokens. Return ',' by default
-    char FindDelimiter(const std::string &s);
+    char FindDelimiter(std::string_view s);
 
     // ';' on WIN32 and ':' on Unix
     char GetEnvDelimiter();
@@ -64,15 +82,17 @@ namespace vl {
 
     std::string ToUpper(const std::string &s);
 
-    bool IsFrameSets(const std::string &s);
+    // Validation scanners run in linear time without allocating
+
+    bool IsFrameSets(std::string_view s);
 
-    VkFrameset ToFrameSet(const std::string &s);
+    VkFrameset ToFrameSet(std::string_view s);
 
-    std::vector<VkFrameset> ToFrameSets(const std::string &s);
+    std::vector<VkFrameset> ToFrameSets(std::string_view s);
 
-    bool IsInteger(const std::string &s);
+    bool IsInteger(std::string_view s);
 
-    bool IsFloat(const std::string &s);
+    bool IsFloat(std::string_view s);
 
     std::string Format(const char *message, ...);
 } // namespace vl
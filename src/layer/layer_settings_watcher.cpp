@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include "layer_settings_watcher.hpp"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <system_error>
+#include <utility>
+
+namespace vl {
+
+#if !defined(__linux__)
+// Interval between two checks of the settings file when inotify is not available
+static const std::chrono::milliseconds WATCHER_POLL_INTERVAL(250);
+#endif
+
+SettingsFileWatcher::~SettingsFileWatcher() { this->Stop(); }
+
+bool SettingsFileWatcher::Start(const std::vector<std::string> &filenames, std::function<void()> on_change) {
+    this->Stop();
+
+    this->on_change = std::move(on_change);
+    this->stopping = false;
+    for (const std::string &filename : filenames) {
+        WatchedFile file;
+        file.filename = filename;
+        const std::size_t name_begin = filename.find_last_of('/');
+        file.name = name_begin == std::string::npos ? filename : filename.substr(name_begin + 1);
+        file.exists = GetFileIdentity(filename.c_str(), file.identity);
+        this->files.push_back(std::move(file));
+    }
+
+#if defined(__linux__)
+    // Editors often save a file by renaming a new file over it, so the events of the directories are watched rather than the
+    // events of the files themselves
+    const uint32_t event_mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+
+    this->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    bool watching = false;
+    for (WatchedFile &file : this->files) {
+        const std::size_t name_begin = file.filename.find_last_of('/');
+        const std::string directory =
+            name_begin == std::string::npos ? "." : file.filename.substr(0, std::max<std::size_t>(name_begin, 1));
+        // A directory watched twice returns the same watch
+        file.watch = this->inotify_fd == -1 ? -1 : inotify_add_watch(this->inotify_fd, directory.c_str(), event_mask);
+        watching = watching || file.watch != -1;
+    }
+
+    if (!watching || pipe2(this->stop_fds, O_CLOEXEC) != 0) {
+        this->Close();
+        return false;
+    }
+#endif
+
+    try {
+        this->thread = std::thread(&SettingsFileWatcher::Run, this);
+    } catch (const std::system_error &) {
+        this->Close();
+        return false;
+    }
+
+    this->filenames = filenames;
+    return true;
+}
+
+void SettingsFileWatcher::Stop() {
+    if (!this->thread.joinable()) {
+        return;
+    }
+
+#if defined(__linux__)
+    this->stopping = true;
+    const ssize_t written = write(this->stop_fds[1], "", 1);
+    (void)written;
+#else
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->stop_condition.notify_all();
+#endif
+
+    this->thread.join();
+    this->Close();
+}
+
+void SettingsFileWatcher::Close() {
+#if defined(__linux__)
+    for (int *fd : {&this->inotify_fd, &this->stop_fds[0], &this->stop_fds[1]}) {
+        if (*fd != -1) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+#endif
+
+    this->files.clear();
+    this->filenames.clear();
+}
+
+void SettingsFileWatcher::Run() {
+#if defined(__linux__)
+    alignas(struct inotify_event) char buffer[4096];
+    struct pollfd fds[2] = {{this->inotify_fd, POLLIN, 0}, {this->stop_fds[0], POLLIN, 0}};
+
+    while (!this->stopping) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents != 0) {
+            break;
+        }
+
+        // Read all the pending events, the files are checked once for all of them
+        bool changed = false;
+        for (ssize_t size; (size = read(this->inotify_fd, buffer, sizeof(buffer))) > 0;) {
+            for (const char *event_data = buffer; event_data < buffer + size;) {
+                const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(event_data);
+                changed = changed || (event->mask & IN_Q_OVERFLOW) != 0 ||
+                          std::any_of(this->files.begin(), this->files.end(), [event](const WatchedFile &file) {
+                              return event->len > 0 && file.watch == event->wd && file.name == event->name;
+                          });
+                event_data += sizeof(struct inotify_event) + event->len;
+            }
+        }
+
+        if (changed) {
+            this->CheckFiles();
+        }
+    }
+#else
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (!this->stop_condition.wait_for(lock, WATCHER_POLL_INTERVAL, [this] { return this->stopping.load(); })) {
+        lock.unlock();
+        this->CheckFiles();
+        lock.lock();
+    }
+#endif
+}
+
+void SettingsFileWatcher::CheckFiles() {
+    bool changed = false;
+    for (WatchedFile &file : this->files) {
+        FileIdentity current_identity;
+        const bool current_exists = GetFileIdentity(file.filename.c_str(), current_identity);
+        if (current_exists == file.exists && (!current_exists || current_identity == file.identity)) {
+            continue;
+        }
+
+        // Updated before the call so that the changes made during the call are seen by the next check
+        file.exists = current_exists;
+        file.identity = current_identity;
+        changed = true;
+    }
+
+    if (changed) {
+        this->on_change();
+    }
+}
+
+}  // namespace vl
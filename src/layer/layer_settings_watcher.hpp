@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#pragma once
+
+#include "layer_settings_file.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vl {
+    // Watch settings files on a thread of their own. A file may not exist yet: its directory is watched, with inotify on
+    // Linux, otherwise by checking the identity of the files periodically.
+    class SettingsFileWatcher {
+      public:
+        SettingsFileWatcher() = default;
+        ~SettingsFileWatcher();
+
+        SettingsFileWatcher(const SettingsFileWatcher &) = delete;
+        SettingsFileWatcher &operator=(const SettingsFileWatcher &) = delete;
+
+        // Call 'on_change' on the watcher thread each time one of the files is modified, replaced, created or removed. Changes
+        // that happen while 'on_change' runs are coalesced in a single call. On Linux, the files which directory doesn't exist
+        // are not watched. Return false when the watcher thread can't start or none of the files can be watched.
+        bool Start(const std::vector<std::string> &filenames, std::function<void()> on_change);
+
+        // Wait for the watcher thread to exit, it must not be called by 'on_change'
+        void Stop();
+
+        // Files given to Start, empty when the watcher is stopped
+        const std::vector<std::string> &GetFilenames() const { return this->filenames; }
+
+      private:
+        struct WatchedFile {
+            std::string filename;
+            std::string name;  // Without the directory
+            int watch{-1};     // inotify watch of the directory
+            bool exists{false};
+            FileIdentity identity;
+        };
+
+        void Run();
+
+        // Call 'on_change' once if the identity of any file changed since the previous call
+        void CheckFiles();
+
+        void Close();
+
+        std::vector<std::string> filenames;
+        std::vector<WatchedFile> files;
+        std::function<void()> on_change;
+
+        std::thread thread;
+        std::atomic<bool> stopping{false};
+#if defined(__linux__)
+        int inotify_fd{-1};
+        int stop_fds[2]{-1, -1};  // Pipe written by Stop to wake up the watcher thread
+#else
+        std::mutex mutex;
+        std::condition_variable stop_condition;
+#endif
+    };
+} // namespace vl
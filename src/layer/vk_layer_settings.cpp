@@ -22,49 +22,635 @@
 
 #include "vulkan/layer/vk_layer_settings.h"
 #include "layer_settings_util.hpp"
+#include "layer_settings_convert.hpp"
+#include "layer_settings_log.hpp"
 #include "layer_settings_manager.hpp"
+#include "layer_settings_rcu.hpp"
+#include "layer_settings_watcher.hpp"
 
+#include <atomic>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
 #include <cstdlib>
 #include <cassert>
 #include <cstring>
 #include <cctype>
 #include <cstring>
 
-static std::unique_ptr<vl::LayerSettings> vk_layer_settings;
+// The layer settings are an immutable snapshot published by vlInitLayerSettings. The queries read it without locking, in a
+// read section, so that they can run concurrently with each other and with vlInitLayerSettings. The previous snapshot is
+// deleted by the publication once its readers left their read section.
+static vl::RcuPointer<vl::LayerSettings> vk_layer_settings;
 
+// Serializes the publications of vlInitLayerSettings and of the hot reloads
+static std::mutex vk_layer_settings_publish_mutex;
+// Incremented after each publication
+static std::atomic<uint64_t> vk_layer_settings_generation{0};
+
+// Watches the settings file while hot reload is enabled. Declared after 'vk_layer_settings' so that the watcher thread is
+// stopped before the layer settings are destroyed at exit.
+static std::mutex vk_layer_settings_watcher_mutex;
+static bool vk_layer_settings_hot_reload = false;
+static vl::SettingsFileWatcher vk_layer_settings_watcher;
+
+struct SettingFlag {
+    std::string name;
+    uint64_t mask;
+};
+
+// Flags registered by vlRegisterLayerSettingFlags, indexed by setting name. Locked after 'vk_layer_settings_publish_mutex'.
+static std::mutex vk_layer_setting_flags_mutex;
+static std::unordered_map<std::string, std::vector<SettingFlag>> vk_layer_setting_flags;
+
+static void ResolveRegisteredSettingFlags(vl::LayerSettings &layer_settings);
+
+// Serializes the initializations
+static std::mutex vk_layer_settings_init_mutex;
+
+// Set while the initialization of vlInitLayerSettingsAsync is running, the queries wait for it to publish the layer settings.
+// The promise is only accessed by the initialization functions, serialized by 'vk_layer_settings_init_mutex', and the thread.
+static std::atomic<bool> vk_layer_settings_init_pending{false};
+static std::promise<void> vk_layer_settings_init_promise;
+static std::mutex vk_layer_settings_pending_mutex;
+static std::shared_future<void> vk_layer_settings_init_done;
+
+// Thread of the last vlInitLayerSettingsAsync call, joined by the next initialization and at exit, before the state it uses is
+// destroyed
+struct LayerSettingsInitThread {
+    ~LayerSettingsInitThread() {
+        if (this->thread.joinable()) {
+            this->thread.join();
+        }
+    }
+
+    std::thread thread;
+};
+
+static LayerSettingsInitThread vk_layer_settings_init_thread;
+
+// Called by the queries before they enter their read section, as publishing the layer settings waits for the readers of the
+// previous ones
+static void WaitForLayerSettingsInit() {
+    if (!vk_layer_settings_init_pending.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    std::shared_future<void> init_done;
+    {
+        std::lock_guard<std::mutex> lock(vk_layer_settings_pending_mutex);
+        init_done = vk_layer_settings_init_done;
+    }
+    init_done.wait();
+}
+
+
+// Not thread-safe: the setting is added to the published layer settings
 void test_helper_SetLayerSetting(const char *pSettingName, const char* pValue) {
-    assert(vk_layer_settings);
     assert(pSettingName != nullptr);
     assert(pValue != nullptr);
 
-    vk_layer_settings->SetFileSetting(pSettingName, pValue);
+    WaitForLayerSettingsInit();
+    vl::RcuReadGuard guard;
+    vl::LayerSettings *layer_settings = vk_layer_settings.Load();
+    assert(layer_settings != nullptr);
+
+    try {
+        layer_settings->SetFileSetting(pSettingName, pValue);
+
+        // Resolve the flags again as if the setting was set by vk_layer_settings.txt
+        ResolveRegisteredSettingFlags(*layer_settings);
+    } catch (const std::bad_alloc &) {
+        assert(0);
+    }
+}
+
+// Must be called with 'vk_layer_settings_publish_mutex' locked
+static void PublishLayerSettings(std::unique_ptr<vl::LayerSettings> layer_settings) {
+    // The flags are resolved before the layer settings are published
+    ResolveRegisteredSettingFlags(*layer_settings);
+
+    vk_layer_settings.Publish(std::move(layer_settings));
+    vk_layer_settings_generation.fetch_add(1, std::memory_order_release);
+}
+
+// Called by the watcher thread when the settings file changes
+static void ReloadLayerSettings() {
+    std::lock_guard<std::mutex> lock(vk_layer_settings_publish_mutex);
+
+    std::unique_ptr<vl::LayerSettings> layer_settings;
+    {
+        vl::RcuReadGuard guard;
+        const vl::LayerSettings *current_layer_settings = vk_layer_settings.Load();
+        if (current_layer_settings == nullptr) {
+            return;
+        }
+
+        try {
+            layer_settings = current_layer_settings->Reload();
+        } catch (const std::bad_alloc &) {
+            return;
+        }
+    }
+
+    try {
+        PublishLayerSettings(std::move(layer_settings));
+    } catch (const std::bad_alloc &) {
+        // The previous layer settings remain published
+    }
+}
+
+// The initializations must not run concurrently: called with 'vk_layer_settings_init_mutex' locked, or by the thread of
+// vlInitLayerSettingsAsync, which the functions locking the mutex join first. The thread can't lock the mutex itself, as it is
+// held while joining the thread. Throw std::bad_alloc if an allocation fails, in which case the previous layer settings remain
+// published. 'environment' is captured by the thread of the application, the reloads use it too.
+static void InitLayerSettings(const char *pLayerName, const VkInstanceCreateInfo *pCreateInfo,
+                              const VkAllocationCallbacks *pAllocator, VL_LAYER_SETTING_LOG_CALLBACK pCallback,
+                              std::shared_ptr<const vl::EnvironmentSnapshot> environment) {
+    // The VK_EXT_layer_settings values are copied, as the layer settings may be reloaded after vkCreateInstance returned
+    std::unique_ptr<vl::LayerSettings> layer_settings(
+        new (pAllocator) vl::LayerSettings(pLayerName, pCreateInfo, pAllocator, pCallback, std::move(environment), true));
+    const std::vector<std::string> settings_files = layer_settings->GetSettingsFileCandidates();
+
+    {
+        std::lock_guard<std::mutex> lock(vk_layer_settings_publish_mutex);
+        PublishLayerSettings(std::move(layer_settings));
+    }
+
+    // Watch the settings files of the new layer settings
+    std::lock_guard<std::mutex> lock(vk_layer_settings_watcher_mutex);
+    if (vk_layer_settings_hot_reload && vk_layer_settings_watcher.GetFilenames() != settings_files) {
+        vk_layer_settings_hot_reload = vk_layer_settings_watcher.Start(settings_files, ReloadLayerSettings);
+    }
+}
+
+// Must be called with 'vk_layer_settings_init_mutex' locked
+static void JoinLayerSettingsInitThread() {
+    // A pending asynchronous initialization must not publish its older layer settings after the next ones
+    if (vk_layer_settings_init_thread.thread.joinable()) {
+        vk_layer_settings_init_thread.thread.join();
+    }
 }
 
 void vlInitLayerSettings(const char *pLayerName, const VkInstanceCreateInfo *pCreateInfo, VL_LAYER_SETTING_LOG_CALLBACK pCallback) {
-    vk_layer_settings = std::make_unique<vl::LayerSettings>(pLayerName, pCreateInfo, pCallback);
+    vlInitLayerSettings2(pLayerName, pCreateInfo, nullptr, pCallback);
+}
+
+VkResult vlInitLayerSettings2(const char *pLayerName, const VkInstanceCreateInfo *pCreateInfo,
+                              const VkAllocationCallbacks *pAllocator, VL_LAYER_SETTING_LOG_CALLBACK pCallback) {
+    std::lock_guard<std::mutex> lock(vk_layer_settings_init_mutex);
+
+    JoinLayerSettingsInitThread();
+
+    try {
+        InitLayerSettings(pLayerName, pCreateInfo, pAllocator, pCallback, vl::EnvironmentSnapshot::Capture());
+    } catch (const std::bad_alloc &) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    return VK_SUCCESS;
+}
+
+void vlDestroyLayerSettings(void) {
+    std::lock_guard<std::mutex> lock(vk_layer_settings_init_mutex);
+
+    JoinLayerSettingsInitThread();
+
+    // The watcher thread publishes the reloads, it is restarted by the next initialization if hot reload is still enabled
+    {
+        std::lock_guard<std::mutex> watcher_lock(vk_layer_settings_watcher_mutex);
+        vk_layer_settings_watcher.Stop();
+    }
+
+    std::lock_guard<std::mutex> publish_lock(vk_layer_settings_publish_mutex);
+    vk_layer_settings.Reset();
+    vk_layer_settings_generation.fetch_add(1, std::memory_order_release);
+}
+
+void vlInitLayerSettingsAsync(const char *pLayerName, const VkInstanceCreateInfo *pCreateInfo,
+                              VL_LAYER_SETTING_LOG_CALLBACK pCallback) {
+    assert(pLayerName != nullptr);
+
+    std::lock_guard<std::mutex> lock(vk_layer_settings_init_mutex);
+
+    JoinLayerSettingsInitThread();
+
+    // The application may free 'pCreateInfo' once vkCreateInstance returns, before the thread runs: the VK_EXT_layer_settings
+    // values of the layer are copied for the thread. The environment is captured here too, as the application may modify it
+    // while the thread runs.
+    std::shared_ptr<vl::Arena> settings_arena;
+    const VkLayerSettingsCreateInfoEXT *settings_create_info = nullptr;
+    std::shared_ptr<const vl::EnvironmentSnapshot> environment;
+    try {
+        settings_arena = std::make_shared<vl::Arena>();
+        settings_create_info = vl::CopyLayerSettingsCreateInfo(*settings_arena, pLayerName, vl::FindSettingsInChain(pCreateInfo));
+        environment = vl::EnvironmentSnapshot::Capture();
+    } catch (const std::bad_alloc &) {
+        // Initialize synchronously, while 'pCreateInfo' is valid
+        try {
+            InitLayerSettings(pLayerName, pCreateInfo, nullptr, pCallback, vl::EnvironmentSnapshot::Capture());
+        } catch (const std::bad_alloc &) {
+            // The previous layer settings remain published
+        }
+        return;
+    }
+
+    auto init = [layer_name = std::string(pLayerName), settings_arena, settings_create_info, environment, pCallback]() {
+        VkInstanceCreateInfo create_info{};
+        create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        create_info.pNext = settings_create_info;
+
+        try {
+            InitLayerSettings(layer_name.c_str(), &create_info, nullptr, pCallback, environment);
+        } catch (const std::bad_alloc &) {
+            // The previous layer settings remain published
+        }
+
+        vk_layer_settings_init_pending.store(false, std::memory_order_release);
+        vk_layer_settings_init_promise.set_value();
+    };
+
+    vk_layer_settings_init_promise = std::promise<void>();
+    {
+        std::lock_guard<std::mutex> pending_lock(vk_layer_settings_pending_mutex);
+        vk_layer_settings_init_done = vk_layer_settings_init_promise.get_future().share();
+    }
+    vk_layer_settings_init_pending.store(true, std::memory_order_release);
+
+    try {
+        vk_layer_settings_init_thread.thread = std::thread(init);
+    } catch (const std::system_error &) {
+        init();
+    }
+}
+
+VkResult vlSetLayerSettingsHotReload(VkBool32 enable) {
+    // The pending initialization locks the watcher mutex too
+    WaitForLayerSettingsInit();
+
+    std::lock_guard<std::mutex> lock(vk_layer_settings_watcher_mutex);
+
+    if (enable == VK_FALSE) {
+        vk_layer_settings_hot_reload = false;
+        vk_layer_settings_watcher.Stop();
+        return VK_SUCCESS;
+    }
+
+    vk_layer_settings_hot_reload = true;
+
+    std::vector<std::string> settings_files;
+    {
+        vl::RcuReadGuard guard;
+        const vl::LayerSettings *layer_settings = vk_layer_settings.Load();
+        if (layer_settings == nullptr) {
+            // The settings files are watched once vlInitLayerSettings found them
+            return VK_SUCCESS;
+        }
+        try {
+            settings_files = layer_settings->GetSettingsFileCandidates();
+        } catch (const std::bad_alloc &) {
+            vk_layer_settings_hot_reload = false;
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+    }
+
+    if (vk_layer_settings_watcher.GetFilenames() == settings_files) {
+        return VK_SUCCESS;
+    }
+
+    if (!vk_layer_settings_watcher.Start(settings_files, ReloadLayerSettings)) {
+        vk_layer_settings_hot_reload = false;
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // The settings file may have changed since the layer settings were initialized, before it was watched
+    ReloadLayerSettings();
+
+    return VK_SUCCESS;
+}
+
+void vlFlushLayerSettingsLog(void) { vl::SettingsLog::Get().Flush(); }
+
+uint64_t vlGetLayerSettingsGeneration(void) { return vk_layer_settings_generation.load(std::memory_order_acquire); }
+
+size_t vlGetLayerSettingsMemoryUsage(void) {
+    WaitForLayerSettingsInit();
+    vl::RcuReadGuard guard;
+    vl::LayerSettings *layer_settings = vk_layer_settings.Load();
+
+    return layer_settings != nullptr ? layer_settings->GetMemoryUsage() : 0;
 }
 
 VkBool32 vlHasLayerSetting(const char *pSettingName) {
-    assert(vk_layer_settings);
     assert(pSettingName);
     assert(!std::string(pSettingName).empty());
 
-    const bool has_env_setting = vk_layer_settings->HasEnvSetting(pSettingName);
-    const bool has_file_setting = vk_layer_settings->HasFileSetting(pSettingName);
-    const bool has_api_setting = vk_layer_settings->HasAPISetting(pSettingName);
+    WaitForLayerSettingsInit();
+    vl::RcuReadGuard guard;
+    vl::LayerSettings *layer_settings = vk_layer_settings.Load();
+    if (layer_settings == nullptr) {
+        return VK_FALSE;
+    }
 
-    return (has_env_setting || has_file_setting || has_api_setting) ? VK_TRUE : VK_FALSE;
+    try {
+        return layer_settings->FindEffectiveSetting(pSettingName) != nullptr ? VK_TRUE : VK_FALSE;
+    } catch (const std::bad_alloc &) {
+        return VK_FALSE;
+    }
 }
 
-VkResult vlGetLayerSettingValues(const char *pSettingName, VkLayerSettingTypeEXT type, uint32_t *pValueCount, void *pValues) {
-    assert(pValueCount != nullptr);
+// Convert every element of a setting list, logging the elements that are invalid or out of range
+template <typename T>
+static void ConvertSettingValues(vl::LayerSettings &layer_settings, const char *pSettingName, std::string_view setting_list,
+                                 char delimiter, vl::ArenaVector<T> &values,
+                                 vl::ConvertResult (*convert)(std::string_view token, T &value), const char *pTypeName) {
+    values.resize(vl::CountTokens(setting_list, delimiter));
+
+    vl::Tokenizer tokenizer(setting_list, delimiter);
+    std::string_view token;
+    for (std::size_t i = 0; tokenizer.Next(token); ++i) {
+        // An empty element, as in "1,,2", is 0 as it always was, without a message
+        if (token.empty()) {
+            values[i] = T{};
+            continue;
+        }
+
+        const vl::ConvertResult result = convert(token, values[i]);
+        if (result == vl::CONVERT_SUCCESS) {
+            continue;
+        }
+
+        values[i] = T{};
+
+        const char *pFormat = result == vl::CONVERT_ERROR_OUT_OF_RANGE
+                                  ? "The data provided (%.*s) at index %u is out of the range of %s values."
+                                  : "The data provided (%.*s) at index %u is not a valid %s value.";
+        const std::string &message =
+            vl::Format(pFormat, static_cast<int>(token.size()), token.data(), static_cast<uint32_t>(i), pTypeName);
+        layer_settings.Log(pSettingName, message.c_str());
+    }
+}
+
+// Parse the values of an environment variable or vk_layer_settings.txt once per type
+static void ParseSettingValues(vl::LayerSettings &layer_settings, const char *pSettingName, std::string_view setting_list,
+                               VkLayerSettingTypeEXT type, vl::SettingCache &cache) {
+    const char deliminater = vl::FindDelimiter(setting_list);
+
+    switch (type) {
+        default:
+            assert(0);
+            break;
+        case VK_LAYER_SETTING_TYPE_BOOL_EXT:
+            ConvertSettingValues(layer_settings, pSettingName, setting_list, deliminater, cache.asBool32, vl::ConvertBool32,
+                                 "boolean");
+            break;
+        case VK_LAYER_SETTING_TYPE_INT32_EXT:
+            ConvertSettingValues(layer_settings, pSettingName, setting_list, deliminater, cache.asInt32, vl::ConvertInt32,
+                                 "int32_t");
+            break;
+        case VK_LAYER_SETTING_TYPE_INT64_EXT:
+            ConvertSettingValues(layer_settings, pSettingName, setting_list, deliminater, cache.asInt64, vl::ConvertInt64,
+                                 "int64_t");
+            break;
+        case VK_LAYER_SETTING_TYPE_UINT32_EXT:
+            ConvertSettingValues(layer_settings, pSettingName, setting_list, deliminater, cache.asUint32, vl::ConvertUint32,
+                                 "uint32_t");
+            break;
+        case VK_LAYER_SETTING_TYPE_UINT64_EXT:
+            ConvertSettingValues(layer_settings, pSettingName, setting_list, deliminater, cache.asUint64, vl::ConvertUint64,
+                                 "uint64_t");
+            break;
+        case VK_LAYER_SETTING_TYPE_FLOAT_EXT:
+            ConvertSettingValues(layer_settings, pSettingName, setting_list, deliminater, cache.asFloat, vl::ConvertFloat,
+                                 "float");
+            break;
+        case VK_LAYER_SETTING_TYPE_DOUBLE_EXT:
+            ConvertSettingValues(layer_settings, pSettingName, setting_list, deliminater, cache.asDouble, vl::ConvertDouble,
+                                 "double");
+            break;
+        case VK_LAYER_SETTING_TYPE_FRAMESET_EXT: {
+            cache.asFrameset.resize(vl::CountTokens(setting_list, deliminater));
+
+            vl::Tokenizer tokenizer(setting_list, deliminater);
+            std::string_view token;
+            for (std::size_t i = 0; tokenizer.Next(token); ++i) {
+                if (vl::IsFrameSets(token)) {
+                    cache.asFrameset[i] = vl::ToFrameSet(token);
+                } else {
+                    const std::string &message = vl::Format("The data provided (%.*s) is not a FrameSet value.",
+                                                            static_cast<int>(token.size()), token.data());
+                    layer_settings.Log(pSettingName, message.c_str());
+                }
+            }
+            break;
+        }
+        case VK_LAYER_SETTING_TYPE_STRING_EXT: {
+            // A single copy of the list, which delimiters are replaced by null terminators
+            cache.asString.assign(setting_list);
+            cache.asStringPointer.resize(vl::CountTokens(setting_list, deliminater));
+
+            vl::Tokenizer tokenizer(setting_list, deliminater);
+            std::string_view token;
+            for (std::size_t i = 0; tokenizer.Next(token); ++i) {
+                const std::size_t offset = static_cast<std::size_t>(token.data() - setting_list.data());
+                cache.asString[offset + token.size()] = '\0';
+                cache.asStringPointer[i] = cache.asString.data() + offset;
+            }
+            break;
+        }
+    }
+}
+
+static std::size_t GetSettingTypeSize(VkLayerSettingTypeEXT type) {
+    switch (type) {
+        default:
+        case VK_LAYER_SETTING_TYPE_BOOL_EXT:
+            return sizeof(VkBool32);
+        case VK_LAYER_SETTING_TYPE_INT32_EXT:
+            return sizeof(int32_t);
+        case VK_LAYER_SETTING_TYPE_INT64_EXT:
+            return sizeof(int64_t);
+        case VK_LAYER_SETTING_TYPE_UINT32_EXT:
+            return sizeof(uint32_t);
+        case VK_LAYER_SETTING_TYPE_UINT64_EXT:
+            return sizeof(uint64_t);
+        case VK_LAYER_SETTING_TYPE_FLOAT_EXT:
+            return sizeof(float);
+        case VK_LAYER_SETTING_TYPE_DOUBLE_EXT:
+            return sizeof(double);
+        case VK_LAYER_SETTING_TYPE_FRAMESET_EXT:
+            return sizeof(VkFrameset);
+        case VK_LAYER_SETTING_TYPE_STRING_EXT:
+            return sizeof(const char *);
+    }
+}
+
+static VkResult CopySettingValues(const void *values, std::size_t count, VkLayerSettingTypeEXT type, uint32_t *pValueCount,
+                                  void *pValues) {
+    const bool copy_values = *pValueCount > 0 && pValues != nullptr;
+
+    if (!copy_values) {
+        *pValueCount = static_cast<uint32_t>(count);
+        return VK_SUCCESS;
+    }
+
+    const std::size_t size = std::min(static_cast<std::size_t>(*pValueCount), count);
+    if (size > 0) {
+        std::memcpy(pValues, values, size * GetSettingTypeSize(type));
+    }
+
+    return static_cast<std::size_t>(*pValueCount) < count ? VK_INCOMPLETE : VK_SUCCESS;
+}
+
+static void ClearSettingValues(vl::SettingCache &cache, VkLayerSettingTypeEXT type) {
+    switch (type) {
+        default:
+        case VK_LAYER_SETTING_TYPE_BOOL_EXT:
+            cache.asBool32.clear();
+            break;
+        case VK_LAYER_SETTING_TYPE_INT32_EXT:
+            cache.asInt32.clear();
+            break;
+        case VK_LAYER_SETTING_TYPE_INT64_EXT:
+            cache.asInt64.clear();
+            break;
+        case VK_LAYER_SETTING_TYPE_UINT32_EXT:
+            cache.asUint32.clear();
+            break;
+        case VK_LAYER_SETTING_TYPE_UINT64_EXT:
+            cache.asUint64.clear();
+            break;
+        case VK_LAYER_SETTING_TYPE_FLOAT_EXT:
+            cache.asFloat.clear();
+            break;
+        case VK_LAYER_SETTING_TYPE_DOUBLE_EXT:
+            cache.asDouble.clear();
+            break;
+        case VK_LAYER_SETTING_TYPE_FRAMESET_EXT:
+            cache.asFrameset.clear();
+            break;
+        case VK_LAYER_SETTING_TYPE_STRING_EXT:
+            cache.asString.clear();
+            cache.asStringPointer.clear();
+            break;
+    }
+}
+
+// Find the values of a setting for a type: the VK_EXT_layer_settings values or the environment variable or
+// vk_layer_settings.txt values, parsed by the first query of each type
+static VkResult FindEffectiveSettingValues(vl::LayerSettings &layer_settings, VlLayerSettingHandle handle,
+                                           const vl::EffectiveSetting &effective_setting, VkLayerSettingTypeEXT type,
+                                           const void **ppValues, std::size_t *pCount) {
+    const std::string_view setting_list = effective_setting.values;
+    const vl::LayerSetting *api_setting = effective_setting.api_setting;
+
+    if (setting_list.empty() && api_setting == nullptr) {
+        return VK_INCOMPLETE;
+    }
+
+    if (static_cast<uint32_t>(type) > static_cast<uint32_t>(VK_LAYER_SETTING_TYPE_STRING_EXT)) {
+        const std::string &message = vl::Format("Unknown VkLayerSettingTypeEXT `type` value: %d.", type);
+        layer_settings.Log(effective_setting.name.data(), message.c_str());
+        return VK_ERROR_UNKNOWN;
+    }
+
+    if (setting_list.empty()) {  // From Vulkan Layer Setting API
+        *ppValues = api_setting->asBool32;
+        *pCount = api_setting->count;
+        return VK_SUCCESS;
+    }
+
+    // From env variable or setting file, parsed by the first query of each type
+    vl::SettingCache &cache = layer_settings.GetSettingCache(handle);
+    cache.BuildOnce(vl::SettingCache::GetTypeBit(type), [&]() {
+        try {
+            ParseSettingValues(layer_settings, effective_setting.name.data(), setting_list, type, cache);
+        } catch (...) {
+            // The values are parsed again by the next query rather than partially returned
+            ClearSettingValues(cache, type);
+            throw;
+        }
+    });
+
+    switch (type) {
+        default:
+        case VK_LAYER_SETTING_TYPE_BOOL_EXT:
+            *ppValues = cache.asBool32.data();
+            *pCount = cache.asBool32.size();
+            break;
+        case VK_LAYER_SETTING_TYPE_INT32_EXT:
+            *ppValues = cache.asInt32.data();
+            *pCount = cache.asInt32.size();
+            break;
+        case VK_LAYER_SETTING_TYPE_INT64_EXT:
+            *ppValues = cache.asInt64.data();
+            *pCount = cache.asInt64.size();
+            break;
+        case VK_LAYER_SETTING_TYPE_UINT32_EXT:
+            *ppValues = cache.asUint32.data();
+            *pCount = cache.asUint32.size();
+            break;
+        case VK_LAYER_SETTING_TYPE_UINT64_EXT:
+            *ppValues = cache.asUint64.data();
+            *pCount = cache.asUint64.size();
+            break;
+        case VK_LAYER_SETTING_TYPE_FLOAT_EXT:
+            *ppValues = cache.asFloat.data();
+            *pCount = cache.asFloat.size();
+            break;
+        case VK_LAYER_SETTING_TYPE_DOUBLE_EXT:
+            *ppValues = cache.asDouble.data();
+            *pCount = cache.asDouble.size();
+            break;
+        case VK_LAYER_SETTING_TYPE_FRAMESET_EXT:
+            *ppValues = cache.asFrameset.data();
+            *pCount = cache.asFrameset.size();
+            break;
+        case VK_LAYER_SETTING_TYPE_STRING_EXT:
+            *ppValues = cache.asStringPointer.data();
+            *pCount = cache.asStringPointer.size();
+            break;
+    }
+
+    return VK_SUCCESS;
+}
+
+// Find the values of a setting as strings. Return 0 values for VK_EXT_layer_settings values of another type.
+static std::size_t FindEffectiveStringValues(vl::LayerSettings &layer_settings, VlLayerSettingHandle handle,
+                                             const vl::EffectiveSetting &effective_setting, const char *const **pppValues) {
+    const vl::LayerSetting *api_setting = effective_setting.api_setting;
+    if (effective_setting.values.empty() && (api_setting == nullptr || api_setting->type != VK_LAYER_SETTING_TYPE_STRING_EXT)) {
+        return 0;
+    }
 
-    if (!vk_layer_settings) {
+    const void *values = nullptr;
+    std::size_t count = 0;
+    if (FindEffectiveSettingValues(layer_settings, handle, effective_setting, VK_LAYER_SETTING_TYPE_STRING_EXT, &values, &count) !=
+        VK_SUCCESS) {
+        return 0;
+    }
+
+    *pppValues = static_cast<const char *const *>(values);
+    return count;
+}
+
+static VkResult GetEffectiveSettingValues(vl::LayerSettings &layer_settings, VlLayerSettingHandle handle,
+                                          VkLayerSettingTypeEXT type, uint32_t *pValueCount, void *pValues) {
+    // The handle may have been found before a reload, the setting it referred to is not resolved to another one
+    if (layer_settings.IsForeignHandle(handle)) {
+        *pValueCount = 0;
         return VK_ERROR_INITIALIZATION_FAILED;
     }
 
-    if (!vlHasLayerSetting(pSettingName)) {
+    const vl::EffectiveSetting *effective_setting = layer_settings.GetEffectiveSetting(handle);
+    if (effective_setting == nullptr) {
         *pValueCount = 0;
         return VK_SUCCESS;
     }
@@ -73,411 +659,408 @@ VkResult vlGetLayerSettingValues(const char *pSettingName, VkLayerSettingTypeEXT
         return VK_ERROR_UNKNOWN;
     }
 
-    // First: search in the environment variables
-    const std::string &env_setting_list = vk_layer_settings->GetEnvSetting(pSettingName);
+    const void *values = nullptr;
+    std::size_t count = 0;
 
-    // Second: search in vk_layer_settings.txt
-    const std::string &file_setting_list = vk_layer_settings->GetFileSetting(pSettingName);
+    const VkResult result = FindEffectiveSettingValues(layer_settings, handle, *effective_setting, type, &values, &count);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
 
-    // Third: search from VK_EXT_layer_settings usage
-    const vl::LayerSetting *api_setting = vk_layer_settings->GetAPISetting(pSettingName);
+    return CopySettingValues(values, count, type, pValueCount, pValues);
+}
 
-    // Environment variables overrides the values set by vk_layer_settings
-    const std::string setting_list = env_setting_list.empty() ? file_setting_list : env_setting_list;
+VkResult vlCreateLayerSettingSet(const char *pLayerName, const VkInstanceCreateInfo *pCreateInfo,
+                                 const VkAllocationCallbacks *pAllocator, VL_LAYER_SETTING_LOG_CALLBACK pCallback,
+                                 VlLayerSettingSet *pLayerSettingSet) {
+    assert(pLayerName != nullptr);
+    assert(pLayerSettingSet != nullptr);
 
-    if (setting_list.empty() && api_setting == nullptr) {
-        return VK_INCOMPLETE;
+    std::unique_ptr<vl::LayerSettings> layer_settings;
+    try {
+        layer_settings.reset(
+            new (pAllocator) vl::LayerSettings(pLayerName, pCreateInfo, pAllocator, pCallback, vl::EnvironmentSnapshot::Capture()));
+        ResolveRegisteredSettingFlags(*layer_settings);
+    } catch (const std::bad_alloc &) {
+        *pLayerSettingSet = nullptr;
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
     }
 
-    const char deliminater = vl::FindDelimiter(setting_list);
-    const std::vector<std::string> &settings(vl::Split(setting_list, deliminater));
+    *pLayerSettingSet = reinterpret_cast<VlLayerSettingSet>(layer_settings.release());
+    return VK_SUCCESS;
+}
 
-    const bool copy_values = *pValueCount > 0 && pValues != nullptr;
+void vlDestroyLayerSettingSet(VlLayerSettingSet layerSettingSet) {
+    delete reinterpret_cast<vl::LayerSettings *>(layerSettingSet);
+}
 
-    switch (type) {
-        default: {
-            const std::string& message = vl::Format("Unknown VkLayerSettingTypeEXT `type` value: %d.", type);
-            vk_layer_settings->Log(pSettingName, message.c_str());
-            return VK_ERROR_UNKNOWN;
-        }
-        case VK_LAYER_SETTING_TYPE_BOOL_EXT: {
-            std::vector<VkBool32> values;
-            VkResult result = VK_SUCCESS;
-
-            if (!settings.empty()) {  // From env variable or setting file
-                if (copy_values) {
-                    if (static_cast<std::size_t>(*pValueCount) < settings.size()) {
-                        result = VK_INCOMPLETE;
-                    }
-                    values.resize(std::min(static_cast<std::size_t>(*pValueCount), settings.size()));
-
-                    for (std::size_t i = 0, n = values.size(); i < n; ++i) {
-                        const std::string &setting_value = vl::ToLower(settings[i]);
-                        if (vl::IsInteger(setting_value)) {
-                            values[i] = (std::atoi(setting_value.c_str()) != 0) ? VK_TRUE : VK_FALSE;
-                        } else if (setting_value == "true" || setting_value == "false") {
-                            values[i] = (setting_value == "true") ? VK_TRUE : VK_FALSE;
-                        } else {
-                            const std::string &message =
-                                vl::Format("The data provided (%s) is not a boolean value.", setting_value.c_str());
-                            vk_layer_settings->Log(pSettingName, message.c_str());
-                        }
-                    }
-                } else {
-                    *pValueCount = static_cast<std::uint32_t>(settings.size());
-                }
-            } else if (api_setting != nullptr) { // From Vulkan Layer Setting API
-                if (copy_values) {
-                    if (*pValueCount < api_setting->count) {
-                        result = VK_INCOMPLETE;
-                    }
-                    const std::uint32_t size = std::min(*pValueCount, api_setting->count);
-                    values.assign(api_setting->asBool32, api_setting->asBool32 + size);
-                } else {
-                    *pValueCount = api_setting->count;
-                }
-            }
+size_t vlGetLayerSettingSetMemoryUsage(VlLayerSettingSet layerSettingSet) {
+    assert(layerSettingSet != nullptr);
 
-            if (copy_values) {
-                std::copy(values.begin(), values.end(), reinterpret_cast<VkBool32 *>(pValues));
-            }
+    return reinterpret_cast<vl::LayerSettings *>(layerSettingSet)->GetMemoryUsage();
+}
 
-            return result;
-        }
-        case VK_LAYER_SETTING_TYPE_INT32_EXT: {
-            std::vector<std::int32_t> values;
-            VkResult result = VK_SUCCESS;
-
-            if (!settings.empty()) {  // From env variable or setting file
-                if (copy_values) {
-                    if (static_cast<std::size_t>(*pValueCount) < settings.size()) {
-                        result = VK_INCOMPLETE;
-                    }
-                    values.resize(std::min(static_cast<std::size_t>(*pValueCount), settings.size()));
-
-                    for (std::size_t i = 0, n = values.size(); i < n; ++i) {
-                        const std::string &setting_value = vl::ToLower(settings[i]);
-                        if (vl::IsInteger(setting_value)) {
-                            values[i] = std::atoi(setting_value.c_str());
-                        } else {
-                            const std::string &message =
-                                vl::Format("The data provided (%s) is not an integer value.", setting_value.c_str());
-                            vk_layer_settings->Log(pSettingName, message.c_str());
-                        }
-                    }
-                } else {
-                    *pValueCount = static_cast<std::uint32_t>(settings.size());
-                }
-            } else if (api_setting != nullptr) {  // From Vulkan Layer Setting API
-                if (copy_values) {
-                    if (*pValueCount < api_setting->count) {
-                        result = VK_INCOMPLETE;
-                    }
-                    const std::uint32_t size = std::min(*pValueCount, api_setting->count);
-                    values.assign(api_setting->asInt32, api_setting->asInt32 + size);
-                } else {
-                    *pValueCount = api_setting->count;
-                }
-            }
+VkBool32 vlHasLayerSettingInSet(VlLayerSettingSet layerSettingSet, const char *pSettingName) {
+    assert(layerSettingSet != nullptr);
+    assert(pSettingName != nullptr);
 
-            if (copy_values) {
-                std::copy(values.begin(), values.end(), reinterpret_cast<std::int32_t *>(pValues));
-            }
+    vl::LayerSettings *layer_settings = reinterpret_cast<vl::LayerSettings *>(layerSettingSet);
+    try {
+        return layer_settings->FindEffectiveSetting(pSettingName) != nullptr ? VK_TRUE : VK_FALSE;
+    } catch (const std::bad_alloc &) {
+        return VK_FALSE;
+    }
+}
 
-            return result;
-        }
-        case VK_LAYER_SETTING_TYPE_INT64_EXT: {
-            std::vector<std::int64_t> values;
-            VkResult result = VK_SUCCESS;
-
-            if (!settings.empty()) {  // From env variable or setting file
-                if (copy_values) {
-                    if (static_cast<std::size_t>(*pValueCount) < settings.size()) {
-                        result = VK_INCOMPLETE;
-                    }
-                    values.resize(std::min(static_cast<std::size_t>(*pValueCount), settings.size()));
-
-                    for (std::size_t i = 0, n = values.size(); i < n; ++i) {
-                        const std::string &setting_value = vl::ToLower(settings[i]);
-                        if (vl::IsInteger(setting_value)) {
-                            values[i] = std::atoll(setting_value.c_str());
-                        } else {
-                            const std::string &message =
-                                vl::Format("The data provided (%s) is not an integer value.", setting_value.c_str());
-                            vk_layer_settings->Log(pSettingName, message.c_str());
-                        }
-                    }
-                } else {
-                    *pValueCount = static_cast<std::uint32_t>(settings.size());
-                }
-            } else if (api_setting != nullptr) {  // From Vulkan Layer Setting API
-                if (copy_values) {
-                    if (*pValueCount < api_setting->count) {
-                        result = VK_INCOMPLETE;
-                    }
-                    const std::uint32_t size = std::min(*pValueCount, api_setting->count);
-                    values.assign(api_setting->asInt64, api_setting->asInt64 + size);
-                } else {
-                    *pValueCount = api_setting->count;
-                }
-            }
+VkResult vlGetLayerSettingSetValues(VlLayerSettingSet layerSettingSet, const char *pSettingName, VkLayerSettingTypeEXT type,
+                                    uint32_t *pValueCount, void *pValues) {
+    assert(layerSettingSet != nullptr);
+    assert(pValueCount != nullptr);
 
-            if (copy_values) {
-                std::copy(values.begin(), values.end(), reinterpret_cast<std::int64_t *>(pValues));
-            }
+    vl::LayerSettings *layer_settings = reinterpret_cast<vl::LayerSettings *>(layerSettingSet);
+    try {
+        const VlLayerSettingHandle handle = layer_settings->FindEffectiveSettingHandle(pSettingName);
 
-            return result;
-        }
-        case VK_LAYER_SETTING_TYPE_UINT32_EXT: {
-            std::vector<std::uint32_t> values;
-            VkResult result = VK_SUCCESS;
-
-            if (!settings.empty()) {  // From env variable or setting file
-                if (copy_values) {
-                    if (static_cast<std::size_t>(*pValueCount) < settings.size()) {
-                        result = VK_INCOMPLETE;
-                    }
-                    values.resize(std::min(static_cast<std::size_t>(*pValueCount), settings.size()));
-
-                    for (std::size_t i = 0, n = values.size(); i < n; ++i) {
-                        const std::string &setting_value = vl::ToLower(settings[i]);
-                        if (vl::IsInteger(setting_value)) {
-                            values[i] = std::atoi(setting_value.c_str());
-                        } else {
-                            const std::string &message =
-                                vl::Format("The data provided (%s) is not an integer value.", setting_value.c_str());
-                            vk_layer_settings->Log(pSettingName, message.c_str());
-                        }
-                    }
-                } else {
-                    *pValueCount = static_cast<std::uint32_t>(settings.size());
-                }
-            } else if (api_setting != nullptr) {  // From Vulkan Layer Setting API
-                if (copy_values) {
-                    if (*pValueCount < api_setting->count) {
-                        result = VK_INCOMPLETE;
-                    }
-                    const uint32_t size = std::min(*pValueCount, api_setting->count);
-                    values.assign(api_setting->asUint32, api_setting->asUint32 + size);
-                } else {
-                    *pValueCount = api_setting->count;
-                }
-            }
+        return GetEffectiveSettingValues(*layer_settings, handle, type, pValueCount, pValues);
+    } catch (const std::bad_alloc &) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+}
+
+VlLayerSettingHandle vlGetLayerSettingSetHandle(VlLayerSettingSet layerSettingSet, const char *pSettingName) {
+    assert(layerSettingSet != nullptr);
+    assert(pSettingName != nullptr);
+
+    try {
+        return reinterpret_cast<vl::LayerSettings *>(layerSettingSet)->FindEffectiveSettingHandle(pSettingName);
+    } catch (const std::bad_alloc &) {
+        return VL_NULL_LAYER_SETTING_HANDLE;
+    }
+}
+
+VkResult vlGetLayerSettingSetValuesByHandle(VlLayerSettingSet layerSettingSet, VlLayerSettingHandle handle,
+                                            VkLayerSettingTypeEXT type, uint32_t *pValueCount, void *pValues) {
+    assert(layerSettingSet != nullptr);
+    assert(pValueCount != nullptr);
+
+    try {
+        return GetEffectiveSettingValues(*reinterpret_cast<vl::LayerSettings *>(layerSettingSet), handle, type, pValueCount,
+                                         pValues);
+    } catch (const std::bad_alloc &) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+}
+
+VkResult vlGetLayerSettingValues(const char *pSettingName, VkLayerSettingTypeEXT type, uint32_t *pValueCount, void *pValues) {
+    assert(pValueCount != nullptr);
+
+    WaitForLayerSettingsInit();
+    vl::RcuReadGuard guard;
+    vl::LayerSettings *layer_settings = vk_layer_settings.Load();
+    if (layer_settings == nullptr) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    try {
+        // Environment variables, vk_layer_settings.txt and VK_EXT_layer_settings are resolved by vlInitLayerSettings
+        const VlLayerSettingHandle handle = layer_settings->FindEffectiveSettingHandle(pSettingName);
+
+        return GetEffectiveSettingValues(*layer_settings, handle, type, pValueCount, pValues);
+    } catch (const std::bad_alloc &) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+}
+
+VlLayerSettingHandle vlGetLayerSettingHandle(const char *pSettingName) {
+    assert(pSettingName != nullptr);
+
+    WaitForLayerSettingsInit();
+    vl::RcuReadGuard guard;
+    vl::LayerSettings *layer_settings = vk_layer_settings.Load();
+    if (layer_settings == nullptr) {
+        return VL_NULL_LAYER_SETTING_HANDLE;
+    }
+
+    try {
+        return layer_settings->FindEffectiveSettingHandle(pSettingName);
+    } catch (const std::bad_alloc &) {
+        return VL_NULL_LAYER_SETTING_HANDLE;
+    }
+}
+
+VkResult vlGetLayerSettingValuesByHandle(VlLayerSettingHandle handle, VkLayerSettingTypeEXT type, uint32_t *pValueCount,
+                                         void *pValues) {
+    assert(pValueCount != nullptr);
 
-            if (copy_values) {
-                std::copy(values.begin(), values.end(), reinterpret_cast<std::uint32_t *>(pValues));
+    WaitForLayerSettingsInit();
+    vl::RcuReadGuard guard;
+    vl::LayerSettings *layer_settings = vk_layer_settings.Load();
+    if (layer_settings == nullptr) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    try {
+        return GetEffectiveSettingValues(*layer_settings, handle, type, pValueCount, pValues);
+    } catch (const std::bad_alloc &) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+}
+
+static VkBool32 IsFrameInFrameset(vl::LayerSettings &layer_settings, VlLayerSettingHandle handle, uint32_t frame) {
+    if (layer_settings.GetEffectiveSetting(handle) == nullptr) {
+        return VK_FALSE;
+    }
+
+    vl::SettingCache &cache = layer_settings.GetSettingCache(handle);
+    try {
+        cache.BuildOnce(vl::SettingCache::FRAMESET_INDEX_READY, [&]() {
+            std::vector<VkFrameset> framesets;
+
+            uint32_t value_count = 0;
+            GetEffectiveSettingValues(layer_settings, handle, VK_LAYER_SETTING_TYPE_FRAMESET_EXT, &value_count, nullptr);
+            if (value_count > 0) {
+                framesets.resize(value_count);
+                GetEffectiveSettingValues(layer_settings, handle, VK_LAYER_SETTING_TYPE_FRAMESET_EXT, &value_count,
+                                          framesets.data());
             }
 
-            return result;
+            vl::Arena &arena = layer_settings.GetArena();
+            cache.frameset_index.reset(arena.New<vl::FramesetIndex>(framesets.data(), framesets.size(), &arena));
+        });
+    } catch (const std::bad_alloc &) {
+        return VK_FALSE;
+    }
+
+    return cache.frameset_index->Contains(frame) ? VK_TRUE : VK_FALSE;
+}
+
+VkBool32 vlIsFrameInLayerSettingFrameset(VlLayerSettingHandle handle, uint32_t frame) {
+    WaitForLayerSettingsInit();
+    vl::RcuReadGuard guard;
+    vl::LayerSettings *layer_settings = vk_layer_settings.Load();
+    if (layer_settings == nullptr) {
+        return VK_FALSE;
+    }
+
+    return IsFrameInFrameset(*layer_settings, handle, frame);
+}
+
+static VkBool32 SettingContains(vl::LayerSettings &layer_settings, VlLayerSettingHandle handle, const char *pValue) {
+    const vl::EffectiveSetting *effective_setting = layer_settings.GetEffectiveSetting(handle);
+    if (effective_setting == nullptr) {
+        return VK_FALSE;
+    }
+
+    vl::SettingCache &cache = layer_settings.GetSettingCache(handle);
+    try {
+        cache.BuildOnce(vl::SettingCache::STRING_SET_READY, [&]() {
+            // The values are referenced by the set: they live in the setting cache or in the VK_EXT_layer_settings values
+            const char *const *values = nullptr;
+            const std::size_t count = FindEffectiveStringValues(layer_settings, handle, *effective_setting, &values);
+
+            vl::Arena &arena = layer_settings.GetArena();
+            cache.string_set.reset(arena.New<vl::StringSet>(values, count, &arena));
+        });
+    } catch (const std::bad_alloc &) {
+        return VK_FALSE;
+    }
+
+    return cache.string_set->Contains(pValue) ? VK_TRUE : VK_FALSE;
+}
+
+VkBool32 vlLayerSettingContains(VlLayerSettingHandle handle, const char *pValue) {
+    assert(pValue != nullptr);
+
+    WaitForLayerSettingsInit();
+    vl::RcuReadGuard guard;
+    vl::LayerSettings *layer_settings = vk_layer_settings.Load();
+    if (layer_settings == nullptr) {
+        return VK_FALSE;
+    }
+
+    return SettingContains(*layer_settings, handle, pValue);
+}
+
+// Resolve the names of the values of a setting into a mask, once, so that layers test the flags with a single AND
+static void ResolveSettingFlags(vl::LayerSettings &layer_settings, const std::string &setting_name,
+                                const std::vector<SettingFlag> &flags) {
+    const VlLayerSettingHandle handle = layer_settings.FindEffectiveSettingHandle(setting_name.c_str());
+    const vl::EffectiveSetting *effective_setting = layer_settings.GetEffectiveSetting(handle);
+    if (effective_setting == nullptr) {
+        return;
+    }
+
+    const char *const *values = nullptr;
+    const std::size_t count = FindEffectiveStringValues(layer_settings, handle, *effective_setting, &values);
+
+    uint64_t mask = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const char *value = values[i];
+        if (value == nullptr || value[0] == '\0') {
+            continue;
         }
-        case VK_LAYER_SETTING_TYPE_UINT64_EXT: {
-            std::vector<std::uint64_t> values;
-            VkResult result = VK_SUCCESS;
-
-            if (!settings.empty()) {  // From env variable or setting file
-                if (copy_values) {
-                    if (static_cast<std::size_t>(*pValueCount) < settings.size()) {
-                        result = VK_INCOMPLETE;
-                    }
-                    values.resize(std::min(static_cast<std::size_t>(*pValueCount), settings.size()));
-
-                    for (std::size_t i = 0, n = values.size(); i < n; ++i) {
-                        const std::string &setting_value = vl::ToLower(settings[i]);
-                        if (vl::IsInteger(setting_value)) {
-                            values[i] = std::atoll(setting_value.c_str());
-                        } else {
-                            const std::string &message =
-                                vl::Format("The data provided (%s) is not an integer value.", setting_value.c_str());
-                            vk_layer_settings->Log(pSettingName, message.c_str());
-                        }
-                    }
-                } else {
-                    *pValueCount = static_cast<std::uint32_t>(settings.size());
-                }
-            } else if (api_setting != nullptr) {  // From Vulkan Layer Setting API
-                if (copy_values) {
-                    if (*pValueCount < api_setting->count) {
-                        result = VK_INCOMPLETE;
-                    }
-                    const std::uint32_t size = std::min(*pValueCount, api_setting->count);
-                    values.assign(api_setting->asUint64, api_setting->asUint64 + size);
-                } else {
-                    *pValueCount = api_setting->count;
-                }
-            }
 
-            if (copy_values) {
-                std::copy(values.begin(), values.end(), reinterpret_cast<std::uint64_t *>(pValues));
-            }
+        auto flag = std::find_if(flags.begin(), flags.end(), [value](const SettingFlag &flag) { return flag.name == value; });
+        if (flag != flags.end()) {
+            mask |= flag->mask;
+        } else {
+            const std::string &message =
+                vl::Format("The data provided (%s) at index %u is not a known flag.", value, static_cast<uint32_t>(i));
+            layer_settings.Log(setting_name.c_str(), message.c_str());
+        }
+    }
+
+    layer_settings.GetSettingCache(handle).flags.store(mask, std::memory_order_relaxed);
+}
+
+static void ResolveRegisteredSettingFlags(vl::LayerSettings &layer_settings) {
+    std::lock_guard<std::mutex> lock(vk_layer_setting_flags_mutex);
+    for (const auto &it : vk_layer_setting_flags) {
+        ResolveSettingFlags(layer_settings, it.first, it.second);
+    }
+}
+
+void vlRegisterLayerSettingFlags(const char *pSettingName, uint32_t flagCount, const VlLayerSettingFlagInfo *pFlags) {
+    assert(pSettingName != nullptr);
+    assert(flagCount == 0 || pFlags != nullptr);
+
+    // No layer settings are published until the flags are resolved on the current ones, the next ones resolve them in
+    // PublishLayerSettings
+    std::lock_guard<std::mutex> publish_lock(vk_layer_settings_publish_mutex);
+    std::lock_guard<std::mutex> lock(vk_layer_setting_flags_mutex);
 
-            return result;
+    try {
+        if (flagCount == 0) {
+            vk_layer_setting_flags.erase(pSettingName);
+            return;
         }
-        case VK_LAYER_SETTING_TYPE_FLOAT_EXT: {
-            std::vector<float> values;
-            VkResult result = VK_SUCCESS;
-
-            if (!settings.empty()) {  // From env variable or setting file
-                if (copy_values) {
-                    if (static_cast<std::size_t>(*pValueCount) < settings.size()) {
-                        result = VK_INCOMPLETE;
-                    }
-                    values.resize(std::min(static_cast<std::size_t>(*pValueCount), settings.size()));
-
-                    for (std::size_t i = 0, n = values.size(); i < n; ++i) {
-                        const std::string &setting_value = vl::ToLower(settings[i]);
-                        if (vl::IsFloat(setting_value)) {
-                            values[i] = std::atof(setting_value.c_str());
-                        } else {
-                            const std::string &message =
-                                vl::Format("The data provided (%s) is not a floating-point value.", setting_value.c_str());
-                            vk_layer_settings->Log(pSettingName, message.c_str());
-                        }
-                    }
-                } else {
-                    *pValueCount = static_cast<std::uint32_t>(settings.size());
-                }
-            } else if (api_setting != nullptr) {  // From Vulkan Layer Setting API
-                if (copy_values) {
-                    if (*pValueCount < api_setting->count) {
-                        result = VK_INCOMPLETE;
-                    }
-                    const std::uint32_t size = std::min(*pValueCount, api_setting->count);
-                    values.assign(api_setting->asFloat, api_setting->asFloat + size);
-                } else {
-                    *pValueCount = api_setting->count;
-                }
-            }
 
-            if (copy_values) {
-                std::copy(values.begin(), values.end(), reinterpret_cast<float *>(pValues));
-            }
+        // The registration is replaced only once the flags are copied
+        std::vector<SettingFlag> flags;
+        flags.reserve(flagCount);
+        for (uint32_t i = 0; i < flagCount; ++i) {
+            assert(pFlags[i].pName != nullptr);
+            flags.push_back(SettingFlag{pFlags[i].pName, pFlags[i].mask});
+        }
+
+        std::vector<SettingFlag> &registered_flags = vk_layer_setting_flags[pSettingName];
+        registered_flags.swap(flags);
 
-            return result;
+        vl::RcuReadGuard guard;
+        vl::LayerSettings *layer_settings = vk_layer_settings.Load();
+        if (layer_settings != nullptr) {
+            ResolveSettingFlags(*layer_settings, pSettingName, registered_flags);
         }
-        case VK_LAYER_SETTING_TYPE_DOUBLE_EXT: {
-            std::vector<double> values;
-            VkResult result = VK_SUCCESS;
-
-            if (!settings.empty()) {  // From env variable or setting file
-                if (copy_values) {
-                    if (static_cast<std::size_t>(*pValueCount) < settings.size()) {
-                        result = VK_INCOMPLETE;
-                    }
-                    values.resize(std::min(static_cast<std::size_t>(*pValueCount), settings.size()));
-
-                    for (std::size_t i = 0, n = values.size(); i < n; ++i) {
-                        const std::string &setting_value = vl::ToLower(settings[i]);
-                        if (vl::IsFloat(setting_value)) {
-                            values[i] = std::atof(setting_value.c_str());
-                        } else {
-                            const std::string &message =
-                                vl::Format("The data provided (%s) is not a floating-point value.", setting_value.c_str());
-                            vk_layer_settings->Log(pSettingName, message.c_str());
-                        }
-                    }
-                } else {
-                    *pValueCount = static_cast<std::uint32_t>(settings.size());
-                }
-            } else if (api_setting != nullptr) {  // From Vulkan Layer Setting API
-                if (copy_values) {
-                    if (*pValueCount < api_setting->count) {
-                        result = VK_INCOMPLETE;
-                    }
-                    const std::uint32_t size = std::min(*pValueCount, api_setting->count);
-                    values.assign(api_setting->asDouble, api_setting->asDouble + size);
-                } else {
-                    *pValueCount = api_setting->count;
-                }
-            }
+    } catch (const std::bad_alloc &) {
+        // The previous registration remains, or the mask remains 0 as for an unset setting
+    }
+}
+
+static uint64_t GetSettingFlags(vl::LayerSettings &layer_settings, VlLayerSettingHandle handle) {
+    if (layer_settings.GetEffectiveSetting(handle) == nullptr) {
+        return 0;
+    }
+
+    return layer_settings.GetSettingCache(handle).flags.load(std::memory_order_relaxed);
+}
+
+uint64_t vlGetLayerSettingFlags(VlLayerSettingHandle handle) {
+    WaitForLayerSettingsInit();
+    vl::RcuReadGuard guard;
+    vl::LayerSettings *layer_settings = vk_layer_settings.Load();
+    if (layer_settings == nullptr) {
+        return 0;
+    }
 
-            if (copy_values) {
-                std::copy(values.begin(), values.end(), reinterpret_cast<double *>(pValues));
+    return GetSettingFlags(*layer_settings, handle);
+}
+
+static VkResult GetSettingValuesBatch(vl::LayerSettings &layer_settings, uint32_t queryCount,
+                                      VlLayerSettingValuesQuery *pQueries) {
+    VkResult batch_result = VK_SUCCESS;
+
+    for (uint32_t i = 0; i < queryCount; ++i) {
+        VlLayerSettingValuesQuery &query = pQueries[i];
+        query.valueCount = 0;
+
+        const void *values = nullptr;
+        std::size_t count = 0;
+
+        try {
+            const VlLayerSettingHandle handle = layer_settings.FindEffectiveSettingHandle(query.pSettingName);
+            const vl::EffectiveSetting *effective_setting = layer_settings.GetEffectiveSetting(handle);
+            if (effective_setting == nullptr) {
+                query.result = VK_SUCCESS;
+                continue;
             }
 
-            return result;
+            query.result = FindEffectiveSettingValues(layer_settings, handle, *effective_setting, query.type, &values, &count);
+        } catch (const std::bad_alloc &) {
+            query.result = VK_ERROR_OUT_OF_HOST_MEMORY;
         }
-        case VK_LAYER_SETTING_TYPE_FRAMESET_EXT: {
-            std::vector<VkFrameset> values;
-            VkResult result = VK_SUCCESS;
-
-            if (!settings.empty()) {  // From env variable or setting file
-                if (copy_values) {
-                    if (static_cast<std::size_t>(*pValueCount) < settings.size()) {
-                        result = VK_INCOMPLETE;
-                    }
-                    values.resize(std::min(static_cast<std::size_t>(*pValueCount), settings.size()));
-
-                    for (std::size_t i = 0, n = values.size(); i < n; ++i) {
-                        const std::string &setting_value = vl::ToLower(settings[i]);
-                        if (vl::IsFrameSets(setting_value)) {
-                            values[i] = vl::ToFrameSet(setting_value.c_str());
-                        } else {
-                            const std::string &message =
-                                vl::Format("The data provided (%s) is not a FrameSet value.", setting_value.c_str());
-                            vk_layer_settings->Log(pSettingName, message.c_str());
-                        }
-                    }
-                } else {
-                    *pValueCount = static_cast<std::uint32_t>(settings.size());
+
+        if (query.result == VK_SUCCESS) {
+            // Fill the count and the values together rather than requiring a second call
+            query.valueCount = static_cast<uint32_t>(count);
+            if (query.pValues != nullptr) {
+                const std::size_t copy_count = std::min(static_cast<std::size_t>(query.capacity), count);
+                if (copy_count > 0) {
+                    std::memcpy(query.pValues, values, copy_count * GetSettingTypeSize(query.type));
                 }
-            } else if (api_setting != nullptr) {  // From Vulkan Layer Setting API
-                if (copy_values) {
-                    if (*pValueCount < api_setting->count) {
-                        result = VK_INCOMPLETE;
-                    }
-                    const std::uint32_t size = std::min(*pValueCount, api_setting->count);
-                    values.assign(api_setting->asFrameset, api_setting->asFrameset + size);
-                } else {
-                    *pValueCount = api_setting->count;
+                if (copy_count < count) {
+                    query.result = VK_INCOMPLETE;
                 }
             }
+        }
 
-            if (copy_values) {
-                std::copy(values.begin(), values.end(), reinterpret_cast<VkFrameset *>(pValues));
+        if (query.result < 0) {
+            if (batch_result >= 0) {
+                batch_result = query.result;
             }
-
-            return result;
+        } else if (query.result == VK_INCOMPLETE && batch_result == VK_SUCCESS) {
+            batch_result = VK_INCOMPLETE;
         }
-        case VK_LAYER_SETTING_TYPE_STRING_EXT: {
-                std::vector<const char*> values;
-                VkResult result = VK_SUCCESS;
-
-                if (!settings.empty()) {  // From env variable or setting file
-                    std::vector<std::string> &settings_cache = vk_layer_settings->GetSettingCache(pSettingName);
-                    settings_cache = settings;
-
-                    if (copy_values) {
-                        if (static_cast<std::size_t>(*pValueCount) < settings_cache.size()) {
-                            result = VK_INCOMPLETE;
-                        }
-                        values.resize(std::min(static_cast<std::size_t>(*pValueCount), settings_cache.size()));
-
-                        for (std::size_t i = 0, n = values.size(); i < n; ++i) {
-                            values[i] = settings_cache[i].c_str();
-                        }
-                    } else {
-                        *pValueCount = static_cast<std::uint32_t>(settings_cache.size());
-                    }
-                } else if (api_setting != nullptr) {  // From Vulkan Layer Setting API
-                    if (copy_values) {
-                        if (*pValueCount < api_setting->count) {
-                            result = VK_INCOMPLETE;
-                        }
-                        const std::uint32_t size = std::min(*pValueCount, api_setting->count);
-                        values.assign(api_setting->asString, api_setting->asString + size);
-                    } else {
-                        *pValueCount = api_setting->count;
-                    }
-                }
+    }
 
-                if (copy_values) {
-                    std::copy(values.begin(), values.end(), reinterpret_cast<const char **>(pValues));
-                }
+    return batch_result;
+}
 
-                return result;
-            }
+VkResult vlGetLayerSettingValuesBatch(uint32_t queryCount, VlLayerSettingValuesQuery *pQueries) {
+    assert(queryCount == 0 || pQueries != nullptr);
+
+    WaitForLayerSettingsInit();
+    vl::RcuReadGuard guard;
+    vl::LayerSettings *layer_settings = vk_layer_settings.Load();
+    if (layer_settings == nullptr) {
+        return VK_ERROR_INITIALIZATION_FAILED;
     }
 
-    return VK_ERROR_UNKNOWN;
+    return GetSettingValuesBatch(*layer_settings, queryCount, pQueries);
 }
 
+VkBool32 vlIsFrameInLayerSettingSetFrameset(VlLayerSettingSet layerSettingSet, VlLayerSettingHandle handle, uint32_t frame) {
+    assert(layerSettingSet != nullptr);
+
+    return IsFrameInFrameset(*reinterpret_cast<vl::LayerSettings *>(layerSettingSet), handle, frame);
+}
+
+VkBool32 vlLayerSettingSetContains(VlLayerSettingSet layerSettingSet, VlLayerSettingHandle handle, const char *pValue) {
+    assert(layerSettingSet != nullptr);
+    assert(pValue != nullptr);
+
+    return SettingContains(*reinterpret_cast<vl::LayerSettings *>(layerSettingSet), handle, pValue);
+}
+
+uint64_t vlGetLayerSettingSetFlags(VlLayerSettingSet layerSettingSet, VlLayerSettingHandle handle) {
+    assert(layerSettingSet != nullptr);
+
+    return GetSettingFlags(*reinterpret_cast<vl::LayerSettings *>(layerSettingSet), handle);
+}
+
+VkResult vlGetLayerSettingSetValuesBatch(VlLayerSettingSet layerSettingSet, uint32_t queryCount,
+                                         VlLayerSettingValuesQuery *pQueries) {
+    assert(layerSettingSet != nullptr);
+    assert(queryCount == 0 || pQueries != nullptr);
+
+    return GetSettingValuesBatch(*reinterpret_cast<vl::LayerSettings *>(layerSettingSet), queryCount, pQueries);
+}
@@ -0,0 +1,621 @@
+/*
+ * Copyright (c) 2023-2023 Valve Corporation
+ * Copyright (c) 2023-2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "vulkan/layer/vk_layer_settings.h"
+#include "test_setting_cache.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+void test_helper_SetLayerSetting(const char *pSettingName, const char *pValue);
+
+// Count every global allocation so each benchmark can report allocations per query
+static std::atomic<std::size_t> allocation_count{0};
+
+void *operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size != 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+static const char *LAYER_NAME = "VK_LAYER_LUNARG_bench";
+static const char *SETTING_NAME = "my_setting";
+static const char *FILE_SETTING_NAME = "lunarg_bench.my_setting";
+static const char *ENV_SETTING_NAME = "VK_LUNARG_BENCH_MY_SETTING";
+
+enum BenchSource {
+    BENCH_SOURCE_ENV,
+    BENCH_SOURCE_FILE,
+    BENCH_SOURCE_API,
+};
+
+static const char *GetSourceName(BenchSource source) {
+    switch (source) {
+        default:
+        case BENCH_SOURCE_ENV:
+            return "env";
+        case BENCH_SOURCE_FILE:
+            return "file";
+        case BENCH_SOURCE_API:
+            return "api";
+    }
+}
+
+static const char *GetTypeName(VkLayerSettingTypeEXT type) {
+    switch (type) {
+        default:
+        case VK_LAYER_SETTING_TYPE_BOOL_EXT:
+            return "bool";
+        case VK_LAYER_SETTING_TYPE_INT32_EXT:
+            return "int32";
+        case VK_LAYER_SETTING_TYPE_INT64_EXT:
+            return "int64";
+        case VK_LAYER_SETTING_TYPE_UINT32_EXT:
+            return "uint32";
+        case VK_LAYER_SETTING_TYPE_UINT64_EXT:
+            return "uint64";
+        case VK_LAYER_SETTING_TYPE_FLOAT_EXT:
+            return "float";
+        case VK_LAYER_SETTING_TYPE_DOUBLE_EXT:
+            return "double";
+        case VK_LAYER_SETTING_TYPE_FRAMESET_EXT:
+            return "frameset";
+        case VK_LAYER_SETTING_TYPE_STRING_EXT:
+            return "string";
+    }
+}
+
+static const char *GetTypeToken(VkLayerSettingTypeEXT type) {
+    switch (type) {
+        default:
+        case VK_LAYER_SETTING_TYPE_BOOL_EXT:
+            return "true";
+        case VK_LAYER_SETTING_TYPE_INT32_EXT:
+        case VK_LAYER_SETTING_TYPE_INT64_EXT:
+            return "-76";
+        case VK_LAYER_SETTING_TYPE_UINT32_EXT:
+        case VK_LAYER_SETTING_TYPE_UINT64_EXT:
+            return "76";
+        case VK_LAYER_SETTING_TYPE_FLOAT_EXT:
+        case VK_LAYER_SETTING_TYPE_DOUBLE_EXT:
+            return "76.5";
+        case VK_LAYER_SETTING_TYPE_FRAMESET_EXT:
+            return "76-100-10";
+        case VK_LAYER_SETTING_TYPE_STRING_EXT:
+            return "VALUE_A";
+    }
+}
+
+static std::size_t GetTypeSize(VkLayerSettingTypeEXT type) {
+    switch (type) {
+        default:
+        case VK_LAYER_SETTING_TYPE_BOOL_EXT:
+            return sizeof(VkBool32);
+        case VK_LAYER_SETTING_TYPE_INT32_EXT:
+            return sizeof(int32_t);
+        case VK_LAYER_SETTING_TYPE_INT64_EXT:
+            return sizeof(int64_t);
+        case VK_LAYER_SETTING_TYPE_UINT32_EXT:
+            return sizeof(uint32_t);
+        case VK_LAYER_SETTING_TYPE_UINT64_EXT:
+            return sizeof(uint64_t);
+        case VK_LAYER_SETTING_TYPE_FLOAT_EXT:
+            return sizeof(float);
+        case VK_LAYER_SETTING_TYPE_DOUBLE_EXT:
+            return sizeof(double);
+        case VK_LAYER_SETTING_TYPE_FRAMESET_EXT:
+            return sizeof(VkFrameset);
+        case VK_LAYER_SETTING_TYPE_STRING_EXT:
+            return sizeof(const char *);
+    }
+}
+
+static void SetEnvironment(const char *variable, const char *value) {
+#if defined(_WIN32)
+    _putenv_s(variable, value != nullptr ? value : "");
+#else
+    if (value != nullptr) {
+        setenv(variable, value, 1);
+    } else {
+        unsetenv(variable);
+    }
+#endif
+}
+
+// Owns the values of one setting and installs them in the requested source
+class BenchSetting {
+  public:
+    BenchSetting(BenchSource source, VkLayerSettingTypeEXT type, std::size_t count) : source(source) {
+        const std::string token = GetTypeToken(type);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i > 0) this->text_values += ",";
+            this->text_values += token;
+        }
+
+        this->string_storage.assign(count, token);
+        for (const std::string &value : this->string_storage) {
+            this->string_values.push_back(value.c_str());
+        }
+
+        if (type == VK_LAYER_SETTING_TYPE_STRING_EXT) {
+            this->setting.asString = this->string_values.data();
+        } else {
+            this->api_values.resize((count * GetTypeSize(type) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+            this->FillAPIValues(type, count);
+            this->setting.value = this->api_values.data();
+        }
+
+        this->setting.pLayerName = LAYER_NAME;
+        this->setting.pSettingName = SETTING_NAME;
+        this->setting.type = type;
+        this->setting.count = static_cast<uint32_t>(count);
+
+        this->create_info.sType = VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT;
+        this->create_info.pNext = nullptr;
+        this->create_info.settingCount = 1;
+        this->create_info.pSettings = &this->setting;
+
+        this->instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        this->instance_create_info.pNext = &this->create_info;
+
+        this->Install();
+    }
+
+    ~BenchSetting() {
+        if (this->source == BENCH_SOURCE_ENV) {
+            SetEnvironment(ENV_SETTING_NAME, nullptr);
+        }
+    }
+
+    // Initialize the layer settings with the setting values, discarding any parsed values
+    void Install() {
+        switch (this->source) {
+            case BENCH_SOURCE_ENV:
+                SetEnvironment(ENV_SETTING_NAME, this->text_values.c_str());
+                vlInitLayerSettings(LAYER_NAME, nullptr, nullptr);
+                break;
+            case BENCH_SOURCE_FILE:
+                vlInitLayerSettings(LAYER_NAME, nullptr, nullptr);
+                test_helper_SetLayerSetting(FILE_SETTING_NAME, this->text_values.c_str());
+                break;
+            case BENCH_SOURCE_API:
+                vlInitLayerSettings(LAYER_NAME, &this->instance_create_info, nullptr);
+                break;
+        }
+    }
+
+  private:
+    template <typename T>
+    void Fill(std::size_t count, T value) {
+        T *data = reinterpret_cast<T *>(this->api_values.data());
+        for (std::size_t i = 0; i < count; ++i) {
+            data[i] = value;
+        }
+    }
+
+    void FillAPIValues(VkLayerSettingTypeEXT type, std::size_t count) {
+        switch (type) {
+            default:
+            case VK_LAYER_SETTING_TYPE_BOOL_EXT:
+                this->Fill<VkBool32>(count, VK_TRUE);
+                break;
+            case VK_LAYER_SETTING_TYPE_INT32_EXT:
+                this->Fill<int32_t>(count, -76);
+                break;
+            case VK_LAYER_SETTING_TYPE_INT64_EXT:
+                this->Fill<int64_t>(count, -76);
+                break;
+            case VK_LAYER_SETTING_TYPE_UINT32_EXT:
+                this->Fill<uint32_t>(count, 76u);
+                break;
+            case VK_LAYER_SETTING_TYPE_UINT64_EXT:
+                this->Fill<uint64_t>(count, 76u);
+                break;
+            case VK_LAYER_SETTING_TYPE_FLOAT_EXT:
+                this->Fill<float>(count, 76.5f);
+                break;
+            case VK_LAYER_SETTING_TYPE_DOUBLE_EXT:
+                this->Fill<double>(count, 76.5);
+                break;
+            case VK_LAYER_SETTING_TYPE_FRAMESET_EXT:
+                this->Fill<VkFrameset>(count, VkFrameset{76, 100, 10});
+                break;
+        }
+    }
+
+    BenchSource source;
+    std::string text_values;
+    std::vector<std::string> string_storage;
+    std::vector<const char *> string_values;
+    std::vector<uint64_t> api_values;
+    VkLayerSettingEXT setting{};
+    VkLayerSettingsCreateInfoEXT create_info{};
+    VkInstanceCreateInfo instance_create_info{};
+};
+
+static void SetAllocationCounter(benchmark::State &state, std::size_t allocations) {
+    state.counters["allocs_per_call"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+static void BM_vlHasLayerSetting(benchmark::State &state, BenchSource source) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    BenchSetting setting(source, VK_LAYER_SETTING_TYPE_STRING_EXT, count);
+
+    const std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(vlHasLayerSetting(SETTING_NAME));
+    }
+    SetAllocationCounter(state, allocation_count.load() - allocations);
+}
+
+static void BM_vlGetLayerSettingValues_Count(benchmark::State &state, BenchSource source, VkLayerSettingTypeEXT type) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    BenchSetting setting(source, type, count);
+
+    const std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        uint32_t value_count = 0;
+        benchmark::DoNotOptimize(vlGetLayerSettingValues(SETTING_NAME, type, &value_count, nullptr));
+        benchmark::DoNotOptimize(value_count);
+    }
+    SetAllocationCounter(state, allocation_count.load() - allocations);
+}
+
+static void BM_vlGetLayerSettingValues(benchmark::State &state, BenchSource source, VkLayerSettingTypeEXT type) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    BenchSetting setting(source, type, count);
+
+    std::vector<uint64_t> values((count * GetTypeSize(type) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+
+    const std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        uint32_t value_count = static_cast<uint32_t>(count);
+        benchmark::DoNotOptimize(vlGetLayerSettingValues(SETTING_NAME, type, &value_count, values.data()));
+        benchmark::ClobberMemory();
+    }
+    SetAllocationCounter(state, allocation_count.load() - allocations);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(count));
+}
+
+// The first query of a setting parses the values of the environment variable or vk_layer_settings.txt
+static void BM_vlGetLayerSettingValues_FirstQuery(benchmark::State &state, BenchSource source, VkLayerSettingTypeEXT type) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    BenchSetting setting(source, type, count);
+
+    std::vector<uint64_t> values((count * GetTypeSize(type) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+
+    std::size_t allocations = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        setting.Install();
+        const std::size_t iteration_allocations = allocation_count.load();
+        state.ResumeTiming();
+
+        uint32_t value_count = static_cast<uint32_t>(count);
+        benchmark::DoNotOptimize(vlGetLayerSettingValues(SETTING_NAME, type, &value_count, values.data()));
+        benchmark::ClobberMemory();
+
+        allocations += allocation_count.load() - iteration_allocations;
+    }
+    SetAllocationCounter(state, allocations);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(count));
+}
+
+static void BM_vlGetLayerSettingValuesByHandle(benchmark::State &state, BenchSource source, VkLayerSettingTypeEXT type) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    BenchSetting setting(source, type, count);
+
+    std::vector<uint64_t> values((count * GetTypeSize(type) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+
+    const VlLayerSettingHandle handle = vlGetLayerSettingHandle(SETTING_NAME);
+
+    const std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        uint32_t value_count = static_cast<uint32_t>(count);
+        benchmark::DoNotOptimize(vlGetLayerSettingValuesByHandle(handle, type, &value_count, values.data()));
+        benchmark::ClobberMemory();
+    }
+    SetAllocationCounter(state, allocation_count.load() - allocations);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(count));
+}
+
+// Many layers passing their settings in the same VkLayerSettingsCreateInfoEXT
+static void BM_vlInitLayerSettings_API(benchmark::State &state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+
+    const int32_t value = 76;
+    const char *layer_names[] = {"VK_LAYER_LUNARG_other", "VK_LAYER_KHRONOS_other", LAYER_NAME};
+
+    std::vector<std::string> setting_names;
+    for (std::size_t i = 0; i < count; ++i) {
+        setting_names.push_back("setting_" + std::to_string(i));
+    }
+
+    std::vector<VkLayerSettingEXT> settings;
+    for (const char *layer_name : layer_names) {
+        for (const std::string &setting_name : setting_names) {
+            VkLayerSettingEXT setting{};
+            setting.pLayerName = layer_name;
+            setting.pSettingName = setting_name.c_str();
+            setting.type = VK_LAYER_SETTING_TYPE_INT32_EXT;
+            setting.count = 1;
+            setting.asInt32 = &value;
+            settings.push_back(setting);
+        }
+    }
+
+    VkLayerSettingsCreateInfoEXT create_info{VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, static_cast<uint32_t>(settings.size()),
+                                             settings.data()};
+
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &create_info;
+
+    const std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        vlInitLayerSettings(LAYER_NAME, &instance_create_info, nullptr);
+        for (const std::string &setting_name : setting_names) {
+            benchmark::DoNotOptimize(vlHasLayerSetting(setting_name.c_str()));
+        }
+    }
+    SetAllocationCounter(state, allocation_count.load() - allocations);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(settings.size()));
+}
+
+// Time spent in vkCreateInstance to initialize the settings of a layer from a settings file of 'range(0)' settings. The
+// asynchronous initialization completes while the timer is paused, by the first query.
+static void BM_vlInitLayerSettings_File(benchmark::State &state, bool async) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+
+    const char *pFilename = "bench_layer_settings_init.txt";
+    {
+        std::ofstream file(pFilename, std::ios::trunc);
+        for (std::size_t i = 0; i < count; ++i) {
+            file << "lunarg_bench.setting_" << i << " = 76,-82,11\n";
+        }
+    }
+    SetEnvironment("VK_LAYER_SETTINGS_PATH", pFilename);
+
+    for (auto _ : state) {
+        if (async) {
+            vlInitLayerSettingsAsync(LAYER_NAME, nullptr, nullptr);
+        } else {
+            vlInitLayerSettings(LAYER_NAME, nullptr, nullptr);
+        }
+
+        state.PauseTiming();
+        benchmark::DoNotOptimize(vlHasLayerSetting("setting_0"));
+        state.ResumeTiming();
+    }
+
+    SetEnvironment("VK_LAYER_SETTINGS_PATH", nullptr);
+    std::remove(pFilename);
+}
+
+// A layer querying all its settings at instance creation, with two calls per setting to size the values first
+static void BM_vlGetLayerSettingValues_AllSettings(benchmark::State &state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+
+    std::vector<std::string> setting_names;
+    vlInitLayerSettings(LAYER_NAME, nullptr, nullptr);
+    for (std::size_t i = 0; i < count; ++i) {
+        setting_names.push_back("setting_" + std::to_string(i));
+        test_helper_SetLayerSetting(("lunarg_bench." + setting_names.back()).c_str(), "76,-82,11");
+    }
+
+    std::vector<int32_t> values(3);
+
+    const std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        for (const std::string &setting_name : setting_names) {
+            uint32_t value_count = 0;
+            vlGetLayerSettingValues(setting_name.c_str(), VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, nullptr);
+            benchmark::DoNotOptimize(
+                vlGetLayerSettingValues(setting_name.c_str(), VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, values.data()));
+        }
+        benchmark::ClobberMemory();
+    }
+    SetAllocationCounter(state, allocation_count.load() - allocations);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(count));
+}
+
+// The same queries filled by a single vlGetLayerSettingValuesBatch call
+static void BM_vlGetLayerSettingValuesBatch(benchmark::State &state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+
+    std::vector<std::string> setting_names;
+    vlInitLayerSettings(LAYER_NAME, nullptr, nullptr);
+    for (std::size_t i = 0; i < count; ++i) {
+        setting_names.push_back("setting_" + std::to_string(i));
+        test_helper_SetLayerSetting(("lunarg_bench." + setting_names.back()).c_str(), "76,-82,11");
+    }
+
+    std::vector<int32_t> values(3 * count);
+    std::vector<VlLayerSettingValuesQuery> queries(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        queries[i].pSettingName = setting_names[i].c_str();
+        queries[i].type = VK_LAYER_SETTING_TYPE_INT32_EXT;
+        queries[i].capacity = 3;
+        queries[i].pValues = &values[i * 3];
+    }
+
+    const std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(vlGetLayerSettingValuesBatch(static_cast<uint32_t>(queries.size()), queries.data()));
+        benchmark::ClobberMemory();
+    }
+    SetAllocationCounter(state, allocation_count.load() - allocations);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(count));
+}
+
+static const VlLayerSettingFlagInfo BENCH_FLAGS[] = {
+    {"error", 0x1}, {"warn", 0x2}, {"perf", 0x4}, {"info", 0x8}, {"verbose", 0x10}};
+
+// A layer testing whether a flag is set by fetching the flag names and comparing them
+static void BM_Flags_Strings(benchmark::State &state) {
+    vlInitLayerSettings(LAYER_NAME, nullptr, nullptr);
+    test_helper_SetLayerSetting(FILE_SETTING_NAME, "error,warn,perf,info,verbose");
+
+    const VlLayerSettingHandle handle = vlGetLayerSettingHandle(SETTING_NAME);
+
+    std::vector<const char *> values(5);
+    for (auto _ : state) {
+        uint32_t value_count = static_cast<uint32_t>(values.size());
+        vlGetLayerSettingValuesByHandle(handle, VK_LAYER_SETTING_TYPE_STRING_EXT, &value_count, values.data());
+
+        bool verbose = false;
+        for (const char *value : values) {
+            verbose |= std::strcmp(value, "verbose") == 0;
+        }
+        benchmark::DoNotOptimize(verbose);
+    }
+}
+
+// The same test with the mask resolved by vlInitLayerSettings
+static void BM_Flags_Mask(benchmark::State &state) {
+    vlRegisterLayerSettingFlags(SETTING_NAME, 5, BENCH_FLAGS);
+    vlInitLayerSettings(LAYER_NAME, nullptr, nullptr);
+    test_helper_SetLayerSetting(FILE_SETTING_NAME, "error,warn,perf,info,verbose");
+
+    const VlLayerSettingHandle handle = vlGetLayerSettingHandle(SETTING_NAME);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize((vlGetLayerSettingFlags(handle) & 0x10) != 0);
+    }
+
+    vlRegisterLayerSettingFlags(SETTING_NAME, 0, nullptr);
+}
+
+// Reader threads querying the same setting concurrently, optionally while the first thread initializes the layer settings again
+// every 1000 queries. The setting is set by VK_EXT_layer_settings because the file settings test hook is not thread-safe.
+static void BM_vlGetLayerSettingValues_Contention(benchmark::State &state, bool reinitialize) {
+    static BenchSetting *setting = nullptr;
+    if (state.thread_index() == 0) {
+        setting = new BenchSetting(BENCH_SOURCE_API, VK_LAYER_SETTING_TYPE_INT32_EXT, 16);
+    }
+
+    std::vector<int32_t> values(16);
+    uint32_t query = 0;
+    for (auto _ : state) {
+        const VlLayerSettingHandle handle = vlGetLayerSettingHandle(SETTING_NAME);
+
+        uint32_t value_count = static_cast<uint32_t>(values.size());
+        benchmark::DoNotOptimize(
+            vlGetLayerSettingValuesByHandle(handle, VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, values.data()));
+        benchmark::ClobberMemory();
+
+        if (reinitialize && state.thread_index() == 0 && ++query % 1000 == 0) {
+            setting->Install();
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+
+    if (state.thread_index() == 0) {
+        delete setting;
+        setting = nullptr;
+    }
+}
+
+int main(int argc, char **argv) {
+    // The benchmarks of the settings file write its binary cache
+    const TestSettingsCacheDirectory settings_cache_directory;
+
+    const BenchSource sources[] = {BENCH_SOURCE_ENV, BENCH_SOURCE_FILE, BENCH_SOURCE_API};
+    const VkLayerSettingTypeEXT types[] = {
+        VK_LAYER_SETTING_TYPE_BOOL_EXT,  VK_LAYER_SETTING_TYPE_INT32_EXT,    VK_LAYER_SETTING_TYPE_INT64_EXT,
+        VK_LAYER_SETTING_TYPE_UINT32_EXT, VK_LAYER_SETTING_TYPE_UINT64_EXT,  VK_LAYER_SETTING_TYPE_FLOAT_EXT,
+        VK_LAYER_SETTING_TYPE_DOUBLE_EXT, VK_LAYER_SETTING_TYPE_FRAMESET_EXT, VK_LAYER_SETTING_TYPE_STRING_EXT};
+
+    benchmark::RegisterBenchmark("vlInitLayerSettings/api", BM_vlInitLayerSettings_API)->RangeMultiplier(10)->Range(1, 10000);
+    benchmark::RegisterBenchmark("vlInitLayerSettings/file", BM_vlInitLayerSettings_File, false)
+        ->RangeMultiplier(10)
+        ->Range(1, 10000);
+    benchmark::RegisterBenchmark("vlInitLayerSettingsAsync/file", BM_vlInitLayerSettings_File, true)
+        ->RangeMultiplier(10)
+        ->Range(1, 10000);
+    benchmark::RegisterBenchmark("vlGetLayerSettingValues_AllSettings/file", BM_vlGetLayerSettingValues_AllSettings)
+        ->RangeMultiplier(10)
+        ->Range(1, 1000);
+    benchmark::RegisterBenchmark("vlGetLayerSettingValuesBatch/file", BM_vlGetLayerSettingValuesBatch)
+        ->RangeMultiplier(10)
+        ->Range(1, 1000);
+    benchmark::RegisterBenchmark("Flags_Strings/file", BM_Flags_Strings);
+    benchmark::RegisterBenchmark("Flags_Mask/file", BM_Flags_Mask);
+    benchmark::RegisterBenchmark("vlGetLayerSettingValues_Contention/api", BM_vlGetLayerSettingValues_Contention, false)
+        ->ThreadRange(1, 64)
+        ->UseRealTime();
+    benchmark::RegisterBenchmark("vlGetLayerSettingValues_Contention/api_reinitialize", BM_vlGetLayerSettingValues_Contention, true)
+        ->ThreadRange(1, 64)
+        ->UseRealTime();
+
+    for (BenchSource source : sources) {
+        const std::string source_name = GetSourceName(source);
+
+        benchmark::RegisterBenchmark(("vlHasLayerSetting/" + source_name).c_str(), BM_vlHasLayerSetting, source)
+            ->RangeMultiplier(10)
+            ->Range(1, 100000);
+
+        for (VkLayerSettingTypeEXT type : types) {
+            const std::string name = source_name + "/" + GetTypeName(type);
+
+            benchmark::RegisterBenchmark(("vlGetLayerSettingValues_Count/" + name).c_str(), BM_vlGetLayerSettingValues_Count,
+                                         source, type)
+                ->RangeMultiplier(10)
+                ->Range(1, 100000);
+
+            benchmark::RegisterBenchmark(("vlGetLayerSettingValues/" + name).c_str(), BM_vlGetLayerSettingValues, source, type)
+                ->RangeMultiplier(10)
+                ->Range(1, 100000);
+
+            benchmark::RegisterBenchmark(("vlGetLayerSettingValues_FirstQuery/" + name).c_str(),
+                                         BM_vlGetLayerSettingValues_FirstQuery, source, type)
+                ->RangeMultiplier(10)
+                ->Range(1, 100000);
+
+            benchmark::RegisterBenchmark(("vlGetLayerSettingValuesByHandle/" + name).c_str(), BM_vlGetLayerSettingValuesByHandle,
+                                         source, type)
+                ->RangeMultiplier(10)
+                ->Range(1, 100000);
+        }
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
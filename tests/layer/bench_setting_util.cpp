@@ -0,0 +1,457 @@
+/*
+ * Copyright (c) 2023-2023 Valve Corporation
+ * Copyright (c) 2023-2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "layer_settings_util.hpp"
+#include "layer_settings_convert.hpp"
+#include "layer_settings_file.hpp"
+#include "layer_settings_frameset.hpp"
+#include "layer_settings_log.hpp"
+#include "layer_settings_string_set.hpp"
+
+#include <regex>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+
+// The std::regex validators replaced by the vl::IsFrameSets, vl::IsInteger and vl::IsFloat scanners
+static bool RegexIsFrameSets(const std::string &s) {
+    static const std::regex FRAME_REGEX("^([0-9]+([-][0-9]+){0,2})(,([0-9]+([-][0-9]+){0,2}))*$");
+
+    return std::regex_search(s, FRAME_REGEX);
+}
+
+static bool RegexIsInteger(const std::string &s) {
+    static const std::regex FRAME_REGEX("^-?([0-9]*|0x[0-9|a-z|A-Z]*)$");
+
+    return std::regex_search(s, FRAME_REGEX);
+}
+
+static bool RegexIsFloat(const std::string &s) {
+    static const std::regex FRAME_REGEX("^-?[0-9]*([.][0-9]*f?)?$");
+
+    return std::regex_search(s, FRAME_REGEX);
+}
+
+// Repeat 'pattern' up to 'size' bytes, ending with a digit so the input is valid
+static std::string MakeInput(const char *pattern, std::size_t size) {
+    std::string input;
+    input.reserve(size);
+    while (input.size() < size) {
+        input += pattern;
+    }
+    input.resize(size);
+    input.back() = '7';
+    return input;
+}
+
+static std::string MakeFloatInput(std::size_t size) {
+    std::string input = MakeInput("7", size);
+    if (size >= 3) {
+        input[size / 2] = '.';
+    }
+    return input;
+}
+
+static void BM_Regex(benchmark::State &state, bool (*Validate)(const std::string &), std::string (*make_input)(std::size_t)) {
+    const std::string input = make_input(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Validate(input));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+static void BM_Scanner(benchmark::State &state, bool (*Validate)(std::string_view), std::string (*make_input)(std::size_t)) {
+    const std::string input = make_input(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Validate(input));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+static std::string MakeFrameSetsInput(std::size_t size) { return MakeInput("1-8-2,", size); }
+
+static std::string MakeIntegerInput(std::size_t size) { return MakeInput("7", size); }
+
+// std::regex recursion overflows the stack around 100 KB inputs, so it is measured on shorter inputs only
+static const int64_t REGEX_MAX_SIZE = 10000;
+static const int64_t SCANNER_MAX_SIZE = 10000000;
+
+BENCHMARK_CAPTURE(BM_Regex, IsFrameSets, RegexIsFrameSets, MakeFrameSetsInput)->RangeMultiplier(10)->Range(1, REGEX_MAX_SIZE);
+BENCHMARK_CAPTURE(BM_Scanner, IsFrameSets, vl::IsFrameSets, MakeFrameSetsInput)->RangeMultiplier(10)->Range(1, SCANNER_MAX_SIZE);
+BENCHMARK_CAPTURE(BM_Regex, IsInteger, RegexIsInteger, MakeIntegerInput)->RangeMultiplier(10)->Range(1, REGEX_MAX_SIZE);
+BENCHMARK_CAPTURE(BM_Scanner, IsInteger, vl::IsInteger, MakeIntegerInput)->RangeMultiplier(10)->Range(1, SCANNER_MAX_SIZE);
+BENCHMARK_CAPTURE(BM_Regex, IsFloat, RegexIsFloat, MakeFloatInput)->RangeMultiplier(10)->Range(1, REGEX_MAX_SIZE);
+BENCHMARK_CAPTURE(BM_Scanner, IsFloat, vl::IsFloat, MakeFloatInput)->RangeMultiplier(10)->Range(1, SCANNER_MAX_SIZE);
+
+// The per-element conversion replaced by vl::ConvertInt64 and vl::ConvertDouble: a lowered copy, a validation pass and a
+// locale-aware conversion
+static void BM_ConvertAtoi(benchmark::State &state, const char *pToken) {
+    const std::vector<std::string> tokens(static_cast<std::size_t>(state.range(0)), pToken);
+    std::vector<int64_t> values(tokens.size());
+
+    for (auto _ : state) {
+        for (std::size_t i = 0, n = tokens.size(); i < n; ++i) {
+            const std::string &token = vl::ToLower(tokens[i]);
+            if (vl::IsInteger(token)) {
+                values[i] = std::atoll(token.c_str());
+            }
+        }
+        benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+static void BM_ConvertInt64(benchmark::State &state, const char *pToken) {
+    const std::vector<std::string> tokens(static_cast<std::size_t>(state.range(0)), pToken);
+    std::vector<int64_t> values(tokens.size());
+
+    for (auto _ : state) {
+        for (std::size_t i = 0, n = tokens.size(); i < n; ++i) {
+            benchmark::DoNotOptimize(vl::ConvertInt64(tokens[i], values[i]));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+static void BM_ConvertAtof(benchmark::State &state, const char *pToken) {
+    const std::vector<std::string> tokens(static_cast<std::size_t>(state.range(0)), pToken);
+    std::vector<double> values(tokens.size());
+
+    for (auto _ : state) {
+        for (std::size_t i = 0, n = tokens.size(); i < n; ++i) {
+            const std::string &token = vl::ToLower(tokens[i]);
+            if (vl::IsFloat(token)) {
+                values[i] = std::atof(token.c_str());
+            }
+        }
+        benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+static void BM_ConvertDouble(benchmark::State &state, const char *pToken) {
+    const std::vector<std::string> tokens(static_cast<std::size_t>(state.range(0)), pToken);
+    std::vector<double> values(tokens.size());
+
+    for (auto _ : state) {
+        for (std::size_t i = 0, n = tokens.size(); i < n; ++i) {
+            benchmark::DoNotOptimize(vl::ConvertDouble(tokens[i], values[i]));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK_CAPTURE(BM_ConvertAtoi, Decimal, "-1234567890")->RangeMultiplier(10)->Range(1, 100000);
+BENCHMARK_CAPTURE(BM_ConvertInt64, Decimal, "-1234567890")->RangeMultiplier(10)->Range(1, 100000);
+BENCHMARK_CAPTURE(BM_ConvertInt64, Hexadecimal, "0x7FFFFFFF")->RangeMultiplier(10)->Range(1, 100000);
+BENCHMARK_CAPTURE(BM_ConvertAtof, Float, "-1234.5678f")->RangeMultiplier(10)->Range(1, 100000);
+BENCHMARK_CAPTURE(BM_ConvertDouble, Float, "-1234.5678f")->RangeMultiplier(10)->Range(1, 100000);
+
+// Write a vk_layer_settings.txt of about 'size' bytes and return its file name
+static std::string MakeSettingsFile(std::size_t size) {
+    const std::string filename = "bench_layer_settings_" + std::to_string(size) + ".txt";
+
+    std::ofstream file(filename, std::ios::binary);
+    std::size_t written = 0;
+    for (std::size_t i = 0; written < size; ++i) {
+        const std::string line = "# Setting " + std::to_string(i) + "\nlunarg_test.setting_" + std::to_string(i) +
+                                 " = VALUE_A,VALUE_B,VALUE_C # Comment\n";
+        file << line;
+        written += line.size();
+    }
+
+    return filename;
+}
+
+// The std::ifstream and std::getline parser replaced by vl::MappedFile and vl::ParseSettingsText
+static void BM_ParseSettingsFile_Getline(benchmark::State &state) {
+    const std::string filename = MakeSettingsFile(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        std::map<std::string, std::string> values;
+
+        std::ifstream file(filename);
+        for (std::string line; std::getline(file, line);) {
+            const auto comments_pos = line.find_first_of('#');
+            if (comments_pos != std::string::npos) line.erase(comments_pos);
+
+            const auto value_pos = line.find_first_of('=');
+            if (value_pos != std::string::npos) {
+                const std::string setting_key = vl::TrimWhitespace(line.substr(0, value_pos));
+                const std::string setting_value = vl::TrimWhitespace(line.substr(value_pos + 1));
+                values[setting_key] = setting_value;
+            }
+        }
+
+        benchmark::DoNotOptimize(values.size());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+
+    std::remove(filename.c_str());
+}
+
+static void BM_ParseSettingsFile_Mapped(benchmark::State &state) {
+    const std::string filename = MakeSettingsFile(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        std::vector<vl::SettingsFileEntry> entries;
+
+        vl::MappedFile file;
+        file.Open(filename.c_str());
+        vl::ParseSettingsText(file.GetText(), 1, entries);
+
+        benchmark::DoNotOptimize(entries.size());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+
+    std::remove(filename.c_str());
+}
+
+static void BM_ParseSettingsFile_Cache(benchmark::State &state) {
+    const std::string filename = MakeSettingsFile(static_cast<std::size_t>(state.range(0)));
+    const std::string cache_filename = filename + ".bin";
+
+    {
+        std::vector<vl::SettingsFileEntry> entries;
+
+        vl::MappedFile file;
+        file.Open(filename.c_str());
+        vl::ParseSettingsText(file.GetText(), 1, entries);
+        const vl::SettingsIndex index{entries.data(), entries.size(), file.GetText()};
+        if (!vl::WriteSettingsCache(cache_filename.c_str(), filename.c_str(), file.GetIdentity(), index)) {
+            state.SkipWithError("The settings cache is not supported");
+        }
+    }
+
+    for (auto _ : state) {
+        vl::SettingsIndex index;
+
+        vl::FileIdentity identity;
+        vl::GetFileIdentity(filename.c_str(), identity);
+
+        vl::MappedFile cache;
+        cache.Open(cache_filename.c_str());
+        benchmark::DoNotOptimize(vl::ReadSettingsCache(cache.GetText(), filename.c_str(), identity, index));
+
+        benchmark::DoNotOptimize(index.entry_count);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+
+    std::remove(cache_filename.c_str());
+    std::remove(filename.c_str());
+}
+
+// Scaling of the parallel parse of an 8 MB settings file with the number of threads in 'range(0)'
+static void BM_ParseSettingsFile_Threads(benchmark::State &state) {
+    const std::size_t size = 8 << 20;
+    const std::string filename = MakeSettingsFile(size);
+
+    vl::MappedFile file;
+    file.Open(filename.c_str());
+
+    for (auto _ : state) {
+        std::vector<vl::SettingsFileEntry> entries;
+        vl::ParseSettingsText(file.GetText(), static_cast<std::size_t>(state.range(0)), entries);
+        benchmark::DoNotOptimize(entries.size());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+
+    file.Close();
+    std::remove(filename.c_str());
+}
+
+BENCHMARK(BM_ParseSettingsFile_Threads)
+    ->DenseRange(1, std::max<int>(static_cast<int>(std::thread::hardware_concurrency()), 1), 1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(BM_ParseSettingsFile_Getline)->RangeMultiplier(8)->Range(1 << 10, 8 << 20)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseSettingsFile_Mapped)->RangeMultiplier(8)->Range(1 << 10, 8 << 20)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseSettingsFile_Cache)->RangeMultiplier(8)->Range(1 << 10, 8 << 20)->Unit(benchmark::kMicrosecond);
+
+// 'range(0)' framesets of 3 frames every 10 frames, queried for each frame as a layer would on each present
+static std::vector<VkFrameset> MakeFramesets(std::size_t count) {
+    std::vector<VkFrameset> framesets(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        framesets[i] = VkFrameset{static_cast<uint32_t>(i * 10), 3, 1};
+    }
+    return framesets;
+}
+
+static void BM_FramesetScan(benchmark::State &state) {
+    const std::vector<VkFrameset> framesets = MakeFramesets(static_cast<std::size_t>(state.range(0)));
+    const uint32_t frame_count = static_cast<uint32_t>(state.range(0) * 10);
+
+    uint32_t frame = 0;
+    for (auto _ : state) {
+        bool selected = false;
+        for (const VkFrameset &frameset : framesets) {
+            if (frame >= frameset.first && (frame - frameset.first) % frameset.step == 0 &&
+                (frame - frameset.first) / frameset.step < frameset.count) {
+                selected = true;
+                break;
+            }
+        }
+        benchmark::DoNotOptimize(selected);
+        frame = frame + 1 < frame_count ? frame + 1 : 0;
+    }
+}
+
+static void BM_FramesetIndex(benchmark::State &state) {
+    const std::vector<VkFrameset> framesets = MakeFramesets(static_cast<std::size_t>(state.range(0)));
+    const vl::FramesetIndex index(framesets.data(), framesets.size());
+    const uint32_t frame_count = static_cast<uint32_t>(state.range(0) * 10);
+
+    uint32_t frame = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.Contains(frame));
+        frame = frame + 1 < frame_count ? frame + 1 : 0;
+    }
+}
+
+BENCHMARK(BM_FramesetScan)->RangeMultiplier(10)->Range(1, 100000);
+BENCHMARK(BM_FramesetIndex)->RangeMultiplier(10)->Range(1, 100000);
+
+// vl::Split allocates a string per token, vl::Tokenizer returns views into the list
+static std::string MakeTokenList(std::size_t count) {
+    std::string list;
+    for (std::size_t i = 0; i < count; ++i) {
+        list += i == 0 ? "VALUE_" : ",VALUE_";
+        list += std::to_string(i);
+    }
+    return list;
+}
+
+static void BM_Split(benchmark::State &state) {
+    const std::string list = MakeTokenList(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(vl::Split(list, ','));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+static void BM_Tokenizer(benchmark::State &state) {
+    const std::string list = MakeTokenList(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        vl::Tokenizer tokenizer(list, ',');
+        for (std::string_view token; tokenizer.Next(token);) {
+            benchmark::DoNotOptimize(token);
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(BM_Split)->RangeMultiplier(10)->Range(1, 100000);
+BENCHMARK(BM_Tokenizer)->RangeMultiplier(10)->Range(1, 100000);
+
+// 'range(0)' message IDs in a filter list, queried with one ID in the list for every 16 IDs not in the list, as a layer would
+// for each validation message
+static std::vector<std::string> MakeMessageIds(std::size_t count, uint32_t seed) {
+    std::vector<std::string> ids(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        ids[i] = vl::Format("0x%08x", static_cast<uint32_t>(i) * 2654435761u + seed);
+    }
+    return ids;
+}
+
+static void BM_StringScan(benchmark::State &state) {
+    const std::vector<std::string> ids = MakeMessageIds(static_cast<std::size_t>(state.range(0)), 0);
+    const std::vector<std::string> queries = MakeMessageIds(16, 1);
+
+    std::size_t query = 0;
+    for (auto _ : state) {
+        const std::string &value = query % 17 == 16 ? ids[query % ids.size()] : queries[query % 17];
+        benchmark::DoNotOptimize(std::find(ids.begin(), ids.end(), value) != ids.end());
+        ++query;
+    }
+}
+
+static void BM_StringSet(benchmark::State &state) {
+    const std::vector<std::string> ids = MakeMessageIds(static_cast<std::size_t>(state.range(0)), 0);
+    const std::vector<std::string> queries = MakeMessageIds(16, 1);
+
+    std::vector<const char *> values;
+    for (const std::string &id : ids) {
+        values.push_back(id.c_str());
+    }
+    const vl::StringSet set(values.data(), values.size());
+
+    std::size_t query = 0;
+    for (auto _ : state) {
+        const std::string &value = query % 17 == 16 ? ids[query % ids.size()] : queries[query % 17];
+        benchmark::DoNotOptimize(set.Contains(value));
+        ++query;
+    }
+}
+
+BENCHMARK(BM_StringScan)->RangeMultiplier(10)->Range(1, 100000);
+BENCHMARK(BM_StringSet)->RangeMultiplier(10)->Range(1, 100000);
+
+static const char *LOG_MESSAGE = "The data provided (0x1G) at index 2 is not an integer.";
+
+// The error of a malformed setting list logged by each query, written synchronously as LayerSettings::Log used to
+static void BM_Log_Synchronous(benchmark::State &state) {
+    static std::mutex mutex;
+    // Unbuffered, as stderr
+    FILE *file = std::tmpfile();
+    std::setvbuf(file, nullptr, _IONBF, 0);
+
+    for (auto _ : state) {
+        std::lock_guard<std::mutex> lock(mutex);
+        fprintf(file, "LAYER SETTING (%s) error: %s\n", "my_setting", LOG_MESSAGE);
+    }
+
+    std::fclose(file);
+}
+
+static void *NullLogCallback(const char *pSettingName, const char *pMessage) {
+    (void)pSettingName;
+    (void)pMessage;
+    return nullptr;
+}
+
+// The same error pushed to the SettingsLog, which only counts the repetitions
+static void BM_Log_SettingsLog(benchmark::State &state) {
+    vl::SettingsLog &log = vl::SettingsLog::Get();
+    static const uint64_t source = log.NewSource();
+
+    for (auto _ : state) {
+        log.Push(source, NullLogCallback, "my_setting", LOG_MESSAGE);
+    }
+
+    if (state.thread_index() == 0) {
+        log.Flush();
+    }
+}
+
+BENCHMARK(BM_Log_Synchronous)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_Log_SettingsLog)->ThreadRange(1, 8)->UseRealTime();
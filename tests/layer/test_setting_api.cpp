@@ -21,7 +21,14 @@
 #include <gtest/gtest.h>
 
 #include "vulkan/layer/vk_layer_settings.h"
+#include "test_setting_cache.hpp"
 #include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstddef>
+
+static const TestSettingsCacheDirectory settings_cache_directory;
 
 TEST(test_layer_setting_api, vlHasLayerSetting_NotFound) {
     vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
@@ -514,3 +521,552 @@ TEST(test_layer_setting_api, vlGetLayerSettingValues_String) {
     EXPECT_STREQ("VALUE_B", values[1]);
     EXPECT_EQ(2, value_count);
 }
+
+TEST(test_layer_setting_api, vlGetLayerSettingValuesByHandle) {
+    std::vector<std::uint32_t> input_values{76, 82};
+
+    std::vector<VkLayerSettingEXT> settings{
+        {"VK_LAYER_LUNARG_test", "my_setting", VK_LAYER_SETTING_TYPE_UINT32_EXT, static_cast<uint32_t>(input_values.size()), {&input_values[0]}},
+        {"VK_LAYER_LUNARG_other", "other_setting", VK_LAYER_SETTING_TYPE_UINT32_EXT, static_cast<uint32_t>(input_values.size()), {&input_values[0]}}};
+
+    VkLayerSettingsCreateInfoEXT layer_settings_create_info{
+        VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, static_cast<uint32_t>(settings.size()), &settings[0]};
+
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &layer_settings_create_info;
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", &instance_create_info, nullptr);
+
+    EXPECT_EQ(VL_NULL_LAYER_SETTING_HANDLE, vlGetLayerSettingHandle("other_setting"));
+    EXPECT_EQ(VL_NULL_LAYER_SETTING_HANDLE, vlGetLayerSettingHandle("missing_setting"));
+
+    VlLayerSettingHandle handle = vlGetLayerSettingHandle("my_setting");
+    EXPECT_NE(VL_NULL_LAYER_SETTING_HANDLE, handle);
+    EXPECT_EQ(handle, vlGetLayerSettingHandle("my_setting"));
+
+    uint32_t value_count = 0;
+    VkResult result_count = vlGetLayerSettingValuesByHandle(handle, VK_LAYER_SETTING_TYPE_UINT32_EXT, &value_count, nullptr);
+    EXPECT_EQ(VK_SUCCESS, result_count);
+    EXPECT_EQ(2, value_count);
+
+    std::vector<std::uint32_t> values(static_cast<uint32_t>(value_count));
+    VkResult result_complete = vlGetLayerSettingValuesByHandle(handle, VK_LAYER_SETTING_TYPE_UINT32_EXT, &value_count, &values[0]);
+    EXPECT_EQ(VK_SUCCESS, result_complete);
+    EXPECT_EQ(76, values[0]);
+    EXPECT_EQ(82, values[1]);
+
+    value_count = 2;
+    VkResult result_null = vlGetLayerSettingValuesByHandle(VL_NULL_LAYER_SETTING_HANDLE, VK_LAYER_SETTING_TYPE_UINT32_EXT, &value_count, nullptr);
+    EXPECT_EQ(VK_SUCCESS, result_null);
+    EXPECT_EQ(0, value_count);
+
+    // The handles of the previous layer settings are rejected rather than resolved to the setting at the same index
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", &instance_create_info, nullptr);
+
+    value_count = 2;
+    VkResult result_stale = vlGetLayerSettingValuesByHandle(handle, VK_LAYER_SETTING_TYPE_UINT32_EXT, &value_count, &values[0]);
+    EXPECT_EQ(VK_ERROR_INITIALIZATION_FAILED, result_stale);
+    EXPECT_EQ(0, value_count);
+    EXPECT_NE(handle, vlGetLayerSettingHandle("my_setting"));
+}
+
+TEST(test_layer_setting_api, vlGetLayerSettingValues_ManyLayers) {
+    std::vector<std::int32_t> input_values{76, 82};
+    std::vector<std::int32_t> duplicated_values{11};
+
+    std::vector<std::string> setting_names;
+    for (std::size_t i = 0; i < 64; ++i) {
+        setting_names.push_back("setting_" + std::to_string(i));
+    }
+
+    std::vector<VkLayerSettingEXT> settings;
+    for (const char *layer_name : {"VK_LAYER_LUNARG_other", "VK_LAYER_LUNARG_test"}) {
+        for (const std::string &setting_name : setting_names) {
+            settings.push_back({layer_name, setting_name.c_str(), VK_LAYER_SETTING_TYPE_INT32_EXT,
+                                static_cast<uint32_t>(input_values.size()), {&input_values[0]}});
+        }
+    }
+    settings.push_back({"VK_LAYER_LUNARG_test", "setting_0", VK_LAYER_SETTING_TYPE_INT32_EXT,
+                        static_cast<uint32_t>(duplicated_values.size()), {&duplicated_values[0]}});
+    settings.push_back({"VK_LAYER_LUNARG_other", "other_setting", VK_LAYER_SETTING_TYPE_INT32_EXT,
+                        static_cast<uint32_t>(duplicated_values.size()), {&duplicated_values[0]}});
+
+    VkLayerSettingsCreateInfoEXT layer_settings_create_info{
+        VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, static_cast<uint32_t>(settings.size()), &settings[0]};
+
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &layer_settings_create_info;
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", &instance_create_info, nullptr);
+
+    EXPECT_FALSE(vlHasLayerSetting("other_setting"));
+
+    for (const std::string &setting_name : setting_names) {
+        EXPECT_TRUE(vlHasLayerSetting(setting_name.c_str()));
+    }
+
+    // The first occurrence of a setting is used
+    uint32_t value_count = 0;
+    VkResult result_count = vlGetLayerSettingValues("setting_0", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, nullptr);
+    EXPECT_EQ(VK_SUCCESS, result_count);
+    EXPECT_EQ(2, value_count);
+}
+
+TEST(test_layer_setting_api, vlIsFrameInLayerSettingFrameset) {
+    std::vector<VkFrameset> input_values{{10, 3, 1}, {100, 4, 10}, {11, 5, 1}};
+
+    std::vector<VkLayerSettingEXT> settings{
+        {"VK_LAYER_LUNARG_test", "my_setting", VK_LAYER_SETTING_TYPE_FRAMESET_EXT, static_cast<uint32_t>(input_values.size()), {&input_values[0]}}};
+
+    VkLayerSettingsCreateInfoEXT layer_settings_create_info{
+        VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, static_cast<uint32_t>(settings.size()), &settings[0]};
+
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &layer_settings_create_info;
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", &instance_create_info, nullptr);
+
+    VlLayerSettingHandle handle = vlGetLayerSettingHandle("my_setting");
+    EXPECT_NE(VL_NULL_LAYER_SETTING_HANDLE, handle);
+
+    EXPECT_FALSE(vlIsFrameInLayerSettingFrameset(handle, 9));
+    EXPECT_TRUE(vlIsFrameInLayerSettingFrameset(handle, 10));
+    EXPECT_TRUE(vlIsFrameInLayerSettingFrameset(handle, 15));
+    EXPECT_FALSE(vlIsFrameInLayerSettingFrameset(handle, 16));
+    EXPECT_TRUE(vlIsFrameInLayerSettingFrameset(handle, 100));
+    EXPECT_FALSE(vlIsFrameInLayerSettingFrameset(handle, 101));
+    EXPECT_TRUE(vlIsFrameInLayerSettingFrameset(handle, 130));
+    EXPECT_FALSE(vlIsFrameInLayerSettingFrameset(handle, 140));
+
+    EXPECT_FALSE(vlIsFrameInLayerSettingFrameset(VL_NULL_LAYER_SETTING_HANDLE, 10));
+}
+
+TEST(test_layer_setting_api, vlLayerSettingContains) {
+    std::vector<const char *> input_values{"VALUE_A", "VALUE_B"};
+    std::vector<std::int32_t> int_values{76};
+
+    std::vector<VkLayerSettingEXT> settings{
+        {"VK_LAYER_LUNARG_test", "my_setting", VK_LAYER_SETTING_TYPE_STRING_EXT, static_cast<uint32_t>(input_values.size()), {&input_values[0]}},
+        {"VK_LAYER_LUNARG_test", "my_int", VK_LAYER_SETTING_TYPE_INT32_EXT, static_cast<uint32_t>(int_values.size()), {&int_values[0]}}};
+
+    VkLayerSettingsCreateInfoEXT layer_settings_create_info{
+        VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, static_cast<uint32_t>(settings.size()), &settings[0]};
+
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &layer_settings_create_info;
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", &instance_create_info, nullptr);
+
+    VlLayerSettingHandle handle = vlGetLayerSettingHandle("my_setting");
+    EXPECT_NE(VL_NULL_LAYER_SETTING_HANDLE, handle);
+
+    EXPECT_TRUE(vlLayerSettingContains(handle, "VALUE_A"));
+    EXPECT_TRUE(vlLayerSettingContains(handle, "VALUE_B"));
+    EXPECT_FALSE(vlLayerSettingContains(handle, "VALUE_C"));
+
+    // Not a string setting
+    EXPECT_FALSE(vlLayerSettingContains(vlGetLayerSettingHandle("my_int"), "76"));
+
+    EXPECT_FALSE(vlLayerSettingContains(VL_NULL_LAYER_SETTING_HANDLE, "VALUE_A"));
+}
+
+TEST(test_layer_setting_api, vlGetLayerSettingFlags) {
+    std::vector<const char *> input_values{"VK_DBG_LAYER_ACTION_LOG_MSG", "VK_DBG_LAYER_ACTION_BREAK"};
+
+    std::vector<VkLayerSettingEXT> settings{
+        {"VK_LAYER_LUNARG_test", "my_flags", VK_LAYER_SETTING_TYPE_STRING_EXT, static_cast<uint32_t>(input_values.size()), {&input_values[0]}}};
+
+    VkLayerSettingsCreateInfoEXT layer_settings_create_info{
+        VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, static_cast<uint32_t>(settings.size()), &settings[0]};
+
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &layer_settings_create_info;
+
+    const VlLayerSettingFlagInfo flags[] = {
+        {"VK_DBG_LAYER_ACTION_IGNORE", 0x0}, {"VK_DBG_LAYER_ACTION_CALLBACK", 0x1}, {"VK_DBG_LAYER_ACTION_LOG_MSG", 0x2},
+        {"VK_DBG_LAYER_ACTION_BREAK", 0x4}, {"VK_DBG_LAYER_ACTION_DEBUG_OUTPUT", 0x8}, {"VK_DBG_LAYER_ACTION_DEFAULT", 0x40}};
+    vlRegisterLayerSettingFlags("my_flags", 6, flags);
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", &instance_create_info, nullptr);
+
+    EXPECT_EQ(0x6, vlGetLayerSettingFlags(vlGetLayerSettingHandle("my_flags")));
+
+    vlRegisterLayerSettingFlags("my_flags", 0, nullptr);
+}
+
+TEST(test_layer_setting_api, vlGetLayerSettingValues_Concurrent) {
+    std::vector<std::int32_t> values_a{76, 76, 76};
+    std::vector<std::int32_t> values_b{82, 82, 82};
+
+    std::vector<VkLayerSettingEXT> settings_a{
+        {"VK_LAYER_LUNARG_test", "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, static_cast<uint32_t>(values_a.size()), {&values_a[0]}}};
+    std::vector<VkLayerSettingEXT> settings_b{
+        {"VK_LAYER_LUNARG_test", "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, static_cast<uint32_t>(values_b.size()), {&values_b[0]}}};
+
+    VkLayerSettingsCreateInfoEXT create_info_a{VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, 1, &settings_a[0]};
+    VkLayerSettingsCreateInfoEXT create_info_b{VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, 1, &settings_b[0]};
+
+    VkInstanceCreateInfo instance_create_info_a{};
+    instance_create_info_a.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info_a.pNext = &create_info_a;
+    VkInstanceCreateInfo instance_create_info_b = instance_create_info_a;
+    instance_create_info_b.pNext = &create_info_b;
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", &instance_create_info_a, nullptr);
+
+    // Readers always see the values of one of the published layer settings, while they are initialized again
+    std::atomic<bool> done{false};
+    std::atomic<uint32_t> mismatch_count{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&]() {
+            while (!done.load()) {
+                uint32_t value_count = 3;
+                std::int32_t values[3] = {};
+                if (vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, values) != VK_SUCCESS ||
+                    values[0] != values[1] || values[1] != values[2] || (values[0] != 76 && values[0] != 82)) {
+                    mismatch_count.fetch_add(1);
+                }
+
+                const VlLayerSettingHandle handle = vlGetLayerSettingHandle("my_setting");
+                if (handle == VL_NULL_LAYER_SETTING_HANDLE) {
+                    mismatch_count.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+        vlInitLayerSettings("VK_LAYER_LUNARG_test", i % 2 == 0 ? &instance_create_info_b : &instance_create_info_a, nullptr);
+    }
+
+    done.store(true);
+    for (std::thread &reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(0, mismatch_count.load());
+}
+
+TEST(test_layer_setting_api, vlCreateLayerSettingSet) {
+    std::vector<std::int32_t> values_a{76, -82};
+    std::vector<std::int32_t> values_b{11};
+
+    std::vector<VkLayerSettingEXT> settings_a{
+        {"VK_LAYER_LUNARG_test", "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, static_cast<uint32_t>(values_a.size()), {&values_a[0]}}};
+    std::vector<VkLayerSettingEXT> settings_b{
+        {"VK_LAYER_LUNARG_test", "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, static_cast<uint32_t>(values_b.size()), {&values_b[0]}}};
+
+    VkLayerSettingsCreateInfoEXT create_info_a{VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, 1, &settings_a[0]};
+    VkLayerSettingsCreateInfoEXT create_info_b{VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, 1, &settings_b[0]};
+
+    VkInstanceCreateInfo instance_create_info_a{};
+    instance_create_info_a.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info_a.pNext = &create_info_a;
+    VkInstanceCreateInfo instance_create_info_b = instance_create_info_a;
+    instance_create_info_b.pNext = &create_info_b;
+
+    // Each instance owns its settings, whatever the order of creation
+    VlLayerSettingSet set_a = nullptr;
+    VlLayerSettingSet set_b = nullptr;
+    EXPECT_EQ(VK_SUCCESS, vlCreateLayerSettingSet("VK_LAYER_LUNARG_test", &instance_create_info_a, nullptr, nullptr, &set_a));
+    EXPECT_EQ(VK_SUCCESS, vlCreateLayerSettingSet("VK_LAYER_LUNARG_test", &instance_create_info_b, nullptr, nullptr, &set_b));
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+    EXPECT_TRUE(vlHasLayerSettingInSet(set_a, "my_setting"));
+    EXPECT_TRUE(vlHasLayerSettingInSet(set_b, "my_setting"));
+    EXPECT_FALSE(vlHasLayerSettingInSet(set_a, "missing_setting"));
+    EXPECT_FALSE(vlHasLayerSetting("my_setting"));
+
+    uint32_t value_count = 0;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingSetValues(set_a, "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, nullptr));
+    EXPECT_EQ(2, value_count);
+
+    std::vector<std::int32_t> values(2);
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingSetValues(set_a, "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &values[0]));
+    EXPECT_EQ(76, values[0]);
+    EXPECT_EQ(-82, values[1]);
+
+    const VlLayerSettingHandle handle_b = vlGetLayerSettingSetHandle(set_b, "my_setting");
+    EXPECT_NE(VL_NULL_LAYER_SETTING_HANDLE, handle_b);
+
+    value_count = 1;
+    EXPECT_EQ(VK_SUCCESS,
+              vlGetLayerSettingSetValuesByHandle(set_b, handle_b, VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &values[0]));
+    EXPECT_EQ(11, values[0]);
+
+    value_count = 1;
+    EXPECT_EQ(VK_ERROR_INITIALIZATION_FAILED,
+              vlGetLayerSettingSetValuesByHandle(set_a, handle_b, VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &values[0]));
+
+    vlDestroyLayerSettingSet(set_a);
+    vlDestroyLayerSettingSet(set_b);
+    vlDestroyLayerSettingSet(nullptr);
+}
+
+TEST(test_layer_setting_api, vlCreateLayerSettingSet_Queries) {
+    std::vector<VkFrameset> frameset_values{{10, 3, 1}, {100, 4, 10}};
+    std::vector<const char *> string_values{"VALUE_A", "VALUE_B"};
+    std::vector<const char *> flag_values{"VK_DBG_LAYER_ACTION_LOG_MSG", "VK_DBG_LAYER_ACTION_BREAK"};
+
+    std::vector<VkLayerSettingEXT> settings{
+        {"VK_LAYER_LUNARG_test", "my_frameset", VK_LAYER_SETTING_TYPE_FRAMESET_EXT, 2, {&frameset_values[0]}},
+        {"VK_LAYER_LUNARG_test", "my_strings", VK_LAYER_SETTING_TYPE_STRING_EXT, 2, {&string_values[0]}},
+        {"VK_LAYER_LUNARG_test", "my_flags", VK_LAYER_SETTING_TYPE_STRING_EXT, 2, {&flag_values[0]}}};
+
+    VkLayerSettingsCreateInfoEXT layer_settings_create_info{
+        VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, static_cast<uint32_t>(settings.size()), &settings[0]};
+
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &layer_settings_create_info;
+
+    const VlLayerSettingFlagInfo flags[] = {{"VK_DBG_LAYER_ACTION_LOG_MSG", 0x2}, {"VK_DBG_LAYER_ACTION_BREAK", 0x4}};
+    vlRegisterLayerSettingFlags("my_flags", 2, flags);
+
+    VlLayerSettingSet set = nullptr;
+    EXPECT_EQ(VK_SUCCESS, vlCreateLayerSettingSet("VK_LAYER_LUNARG_test", &instance_create_info, nullptr, nullptr, &set));
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+    const VlLayerSettingHandle frameset_handle = vlGetLayerSettingSetHandle(set, "my_frameset");
+    EXPECT_TRUE(vlIsFrameInLayerSettingSetFrameset(set, frameset_handle, 12));
+    EXPECT_FALSE(vlIsFrameInLayerSettingSetFrameset(set, frameset_handle, 13));
+    EXPECT_TRUE(vlIsFrameInLayerSettingSetFrameset(set, frameset_handle, 130));
+    EXPECT_FALSE(vlIsFrameInLayerSettingFrameset(frameset_handle, 12));
+
+    const VlLayerSettingHandle strings_handle = vlGetLayerSettingSetHandle(set, "my_strings");
+    EXPECT_TRUE(vlLayerSettingSetContains(set, strings_handle, "VALUE_B"));
+    EXPECT_FALSE(vlLayerSettingSetContains(set, strings_handle, "VALUE_C"));
+    EXPECT_FALSE(vlLayerSettingContains(strings_handle, "VALUE_B"));
+
+    EXPECT_EQ(0x6, vlGetLayerSettingSetFlags(set, vlGetLayerSettingSetHandle(set, "my_flags")));
+    EXPECT_EQ(0, vlGetLayerSettingSetFlags(set, strings_handle));
+
+    const char *string_value = nullptr;
+    VlLayerSettingValuesQuery queries[2] = {
+        {"my_strings", VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &string_value, 0, VK_SUCCESS},
+        {"missing_setting", VK_LAYER_SETTING_TYPE_STRING_EXT, 0, nullptr, 0, VK_SUCCESS}};
+    EXPECT_EQ(VK_INCOMPLETE, vlGetLayerSettingSetValuesBatch(set, 2, queries));
+    EXPECT_EQ(2, queries[0].valueCount);
+    EXPECT_STREQ("VALUE_A", string_value);
+    EXPECT_EQ(0, queries[1].valueCount);
+    EXPECT_EQ(VK_SUCCESS, queries[1].result);
+
+    vlDestroyLayerSettingSet(set);
+    vlRegisterLayerSettingFlags("my_flags", 0, nullptr);
+}
+
+TEST(test_layer_setting_api, vlGetLayerSettingsMemoryUsage) {
+    std::vector<VkLayerSettingEXT> settings;
+    std::vector<std::string> names;
+    std::vector<const char *> values;
+    for (int i = 0; i < 100; ++i) {
+        names.push_back("my_setting_" + std::to_string(i));
+        values.push_back("value");
+    }
+    for (int i = 0; i < 100; ++i) {
+        settings.push_back({"VK_LAYER_LUNARG_test", names[i].c_str(), VK_LAYER_SETTING_TYPE_STRING_EXT, 1, {&values[i]}});
+    }
+
+    VkLayerSettingsCreateInfoEXT create_info{VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, 1, &settings[0]};
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &create_info;
+
+    VlLayerSettingSet small_set = nullptr;
+    EXPECT_EQ(VK_SUCCESS, vlCreateLayerSettingSet("VK_LAYER_LUNARG_test", &instance_create_info, nullptr, nullptr, &small_set));
+
+    create_info.settingCount = static_cast<uint32_t>(settings.size());
+    VlLayerSettingSet large_set = nullptr;
+    EXPECT_EQ(VK_SUCCESS, vlCreateLayerSettingSet("VK_LAYER_LUNARG_test", &instance_create_info, nullptr, nullptr, &large_set));
+
+    const size_t small_usage = vlGetLayerSettingSetMemoryUsage(small_set);
+    EXPECT_NE(0u, small_usage);
+    EXPECT_LT(small_usage, vlGetLayerSettingSetMemoryUsage(large_set));
+
+    vlDestroyLayerSettingSet(small_set);
+    vlDestroyLayerSettingSet(large_set);
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", &instance_create_info, nullptr);
+    EXPECT_NE(0u, vlGetLayerSettingsMemoryUsage());
+}
+
+// Allocation callbacks counting the live allocations, failing when 'fail' is set
+struct AllocationCounter {
+    std::atomic<int> allocation_count{0};
+    std::atomic<int> live_count{0};
+    bool fail{false};
+};
+
+static void *VKAPI_PTR CountingAllocation(void *pUserData, size_t size, size_t alignment, VkSystemAllocationScope) {
+    AllocationCounter *counter = static_cast<AllocationCounter *>(pUserData);
+    if (counter->fail) {
+        return nullptr;
+    }
+    ++counter->allocation_count;
+    ++counter->live_count;
+    EXPECT_LE(alignment, alignof(std::max_align_t));
+    return ::operator new(size);
+}
+
+static void *VKAPI_PTR CountingReallocation(void *, void *, size_t, size_t, VkSystemAllocationScope) { return nullptr; }
+
+static void VKAPI_PTR CountingFree(void *pUserData, void *pMemory) {
+    if (pMemory != nullptr) {
+        --static_cast<AllocationCounter *>(pUserData)->live_count;
+        ::operator delete(pMemory);
+    }
+}
+
+TEST(test_layer_setting_api, VkAllocationCallbacks) {
+    std::vector<std::int32_t> input_values{76, -82};
+    std::vector<VkLayerSettingEXT> settings{
+        {"VK_LAYER_LUNARG_test", "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, static_cast<uint32_t>(input_values.size()), {&input_values[0]}}};
+    VkLayerSettingsCreateInfoEXT create_info{VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, 1, &settings[0]};
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &create_info;
+
+    AllocationCounter counter;
+    VkAllocationCallbacks allocator{&counter, CountingAllocation, CountingReallocation, CountingFree, nullptr, nullptr};
+
+    VlLayerSettingSet set = nullptr;
+    EXPECT_EQ(VK_SUCCESS, vlCreateLayerSettingSet("VK_LAYER_LUNARG_test", &instance_create_info, &allocator, nullptr, &set));
+    EXPECT_LT(0, counter.live_count.load());
+
+    std::vector<std::int32_t> values(2);
+    uint32_t value_count = 2;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingSetValues(set, "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &values[0]));
+    EXPECT_EQ(-82, values[1]);
+
+    // Everything the setting set allocated is freed with its callbacks
+    vlDestroyLayerSettingSet(set);
+    EXPECT_EQ(0, counter.live_count.load());
+
+    // The layer settings are freed with their callbacks by vlDestroyLayerSettings
+    const int allocation_count = counter.allocation_count.load();
+    EXPECT_EQ(VK_SUCCESS, vlInitLayerSettings2("VK_LAYER_LUNARG_test", &instance_create_info, &allocator, nullptr));
+    EXPECT_LT(allocation_count, counter.allocation_count.load());
+    EXPECT_TRUE(vlHasLayerSetting("my_setting"));
+
+    vlDestroyLayerSettings();
+    EXPECT_EQ(0, counter.live_count.load());
+    EXPECT_FALSE(vlHasLayerSetting("my_setting"));
+
+    // A failed initialization leaves the previous layer settings in place
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", &instance_create_info, nullptr);
+    counter.fail = true;
+    EXPECT_EQ(VK_ERROR_OUT_OF_HOST_MEMORY, vlInitLayerSettings2("VK_LAYER_LUNARG_test", nullptr, &allocator, nullptr));
+    EXPECT_TRUE(vlHasLayerSetting("my_setting"));
+
+    set = nullptr;
+    EXPECT_EQ(VK_ERROR_OUT_OF_HOST_MEMORY,
+              vlCreateLayerSettingSet("VK_LAYER_LUNARG_test", &instance_create_info, &allocator, nullptr, &set));
+    EXPECT_EQ(nullptr, set);
+    EXPECT_EQ(0, counter.live_count.load());
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+}
+
+TEST(test_layer_setting_api, vlCreateLayerSettingSet_Concurrent) {
+    const int thread_count = 8;
+
+    std::vector<std::int32_t> values(thread_count);
+    std::vector<VkLayerSettingEXT> settings(thread_count);
+    std::vector<VkLayerSettingsCreateInfoEXT> create_infos(thread_count);
+    std::vector<VkInstanceCreateInfo> instance_create_infos(thread_count);
+    for (int i = 0; i < thread_count; ++i) {
+        values[i] = i;
+        settings[i] = {"VK_LAYER_LUNARG_test", "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, 1, {&values[i]}};
+        create_infos[i] = {VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, 1, &settings[i]};
+        instance_create_infos[i] = {};
+        instance_create_infos[i].sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        instance_create_infos[i].pNext = &create_infos[i];
+    }
+
+    std::atomic<uint32_t> mismatch_count{0};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&, i]() {
+            for (int j = 0; j < 100; ++j) {
+                VlLayerSettingSet set = nullptr;
+                const VkResult result =
+                    vlCreateLayerSettingSet("VK_LAYER_LUNARG_test", &instance_create_infos[i], nullptr, nullptr, &set);
+                if (result != VK_SUCCESS) {
+                    mismatch_count.fetch_add(1);
+                    continue;
+                }
+
+                std::int32_t value = -1;
+                uint32_t value_count = 1;
+                vlGetLayerSettingSetValues(set, "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &value);
+                if (value != i) {
+                    mismatch_count.fetch_add(1);
+                }
+
+                vlDestroyLayerSettingSet(set);
+            }
+        });
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(0, mismatch_count.load());
+}
+
+TEST(test_layer_setting_api, vlInitLayerSettingsAsync) {
+    std::vector<std::int32_t> input_values{76, -82};
+    std::vector<VkLayerSettingEXT> settings{
+        {"VK_LAYER_LUNARG_test", "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, static_cast<uint32_t>(input_values.size()), {&input_values[0]}}};
+    VkLayerSettingsCreateInfoEXT layer_settings_create_info{VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr,
+                                                            static_cast<uint32_t>(settings.size()), &settings[0]};
+
+    // Nothing of the instance create info must outlive the call
+    {
+        std::vector<std::int32_t> freed_values(input_values);
+        std::vector<VkLayerSettingEXT> freed_settings{{"VK_LAYER_LUNARG_test", "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT,
+                                                       static_cast<uint32_t>(freed_values.size()), {&freed_values[0]}}};
+        VkLayerSettingsCreateInfoEXT freed_create_info{VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr,
+                                                       static_cast<uint32_t>(freed_settings.size()), &freed_settings[0]};
+        VkInstanceCreateInfo instance_create_info{};
+        instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        instance_create_info.pNext = &freed_create_info;
+
+        vlInitLayerSettingsAsync("VK_LAYER_LUNARG_test", &instance_create_info, nullptr);
+
+        freed_values.assign(freed_values.size(), 0);
+        freed_settings.assign(freed_settings.size(), VkLayerSettingEXT{});
+        freed_create_info = VkLayerSettingsCreateInfoEXT{};
+    }
+
+    // The first query waits for the initialization
+    EXPECT_TRUE(vlHasLayerSetting("my_setting"));
+
+    std::vector<std::int32_t> values(2);
+    uint32_t value_count = 2;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &values[0]));
+    EXPECT_EQ(76, values[0]);
+    EXPECT_EQ(-82, values[1]);
+
+    // The layer settings of an asynchronous initialization never replace the ones of a later initialization
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &layer_settings_create_info;
+
+    vlInitLayerSettingsAsync("VK_LAYER_LUNARG_test", &instance_create_info, nullptr);
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+    EXPECT_FALSE(vlHasLayerSetting("my_setting"));
+
+    vlInitLayerSettingsAsync("VK_LAYER_LUNARG_test", nullptr, nullptr);
+    vlInitLayerSettingsAsync("VK_LAYER_LUNARG_test", &instance_create_info, nullptr);
+    EXPECT_TRUE(vlHasLayerSetting("my_setting"));
+}
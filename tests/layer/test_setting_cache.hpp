@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2023 Valve Corporation
+ * Copyright (c) 2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#pragma once
+
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <system_error>
+
+// Point $XDG_CACHE_HOME to a temporary directory for the lifetime of the object, so that the binary caches of the settings
+// files written by a test program don't end up in the cache of the user. The directory is removed by the destructor. ctest
+// runs each test in its own process, so that a static instance gives each test its own cache directory.
+class TestSettingsCacheDirectory {
+  public:
+    TestSettingsCacheDirectory() {
+        if (const char *previous = std::getenv("XDG_CACHE_HOME")) {
+            this->previous_value = previous;
+            this->has_previous_value = true;
+        }
+
+        std::random_device random;
+        const std::filesystem::path path =
+            std::filesystem::temp_directory_path() / ("vulkan_layer_settings_test_" + std::to_string(random()));
+        std::error_code error;
+        std::filesystem::create_directories(path, error);
+
+        this->path = path.string();
+        SetCacheHome(this->path.c_str());
+    }
+
+    ~TestSettingsCacheDirectory() {
+        SetCacheHome(this->has_previous_value ? this->previous_value.c_str() : nullptr);
+
+        std::error_code error;
+        std::filesystem::remove_all(this->path, error);
+    }
+
+    TestSettingsCacheDirectory(const TestSettingsCacheDirectory &) = delete;
+    TestSettingsCacheDirectory &operator=(const TestSettingsCacheDirectory &) = delete;
+
+    // Absolute path of the directory
+    const std::string &GetPath() const { return this->path; }
+
+  private:
+    static void SetCacheHome(const char *pValue) {
+#if defined(_WIN32)
+        _putenv_s("XDG_CACHE_HOME", pValue != nullptr ? pValue : "");
+#else
+        if (pValue != nullptr) {
+            setenv("XDG_CACHE_HOME", pValue, 1);
+        } else {
+            unsetenv("XDG_CACHE_HOME");
+        }
+#endif
+    }
+
+    std::string path;
+    std::string previous_value;
+    bool has_previous_value{false};
+};
@@ -0,0 +1,582 @@
+/*
+ * Copyright (c) 2023-2023 Valve Corporation
+ * Copyright (c) 2023-2023 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Authors:
+ * - Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include <gtest/gtest.h>
+
+#include "vulkan/layer/vk_layer_settings.h"
+#include "test_setting_cache.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+void test_helper_SetLayerSetting(const char* pSettingName, const char* pValue);
+
+static const TestSettingsCacheDirectory settings_cache_directory;
+
+static void SetEnv(const char* pName, const char* pValue) {
+#if defined(_WIN32)
+    _putenv_s(pName, pValue != nullptr ? pValue : "");
+#else
+    if (pValue != nullptr) {
+        setenv(pName, pValue, 1);
+    } else {
+        unsetenv(pName);
+    }
+#endif
+}
+
+TEST(test_layer_setting_env, vlGetLayerSettingValues_Int32) {
+    SetEnv("VK_LUNARG_TEST_MY_SETTING", "76,-82");
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+    SetEnv("VK_LUNARG_TEST_MY_SETTING", nullptr);
+
+    // The environment is snapshotted by vlInitLayerSettings
+    EXPECT_TRUE(vlHasLayerSetting("my_setting"));
+
+    uint32_t value_count = 0;
+    VkResult result_count = vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, nullptr);
+    EXPECT_EQ(VK_SUCCESS, result_count);
+    EXPECT_EQ(2, value_count);
+
+    std::vector<std::int32_t> values(static_cast<uint32_t>(value_count));
+    VkResult result_complete = vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &values[0]);
+    EXPECT_EQ(VK_SUCCESS, result_complete);
+    EXPECT_EQ(76, values[0]);
+    EXPECT_EQ(-82, values[1]);
+    EXPECT_EQ(2, value_count);
+}
+
+static std::atomic<uint32_t> empty_elements_message_count{0};
+
+static void* CountEmptyElementsMessage(const char* pSettingName, const char* pMessage) {
+    (void)pSettingName;
+    (void)pMessage;
+    ++empty_elements_message_count;
+    return nullptr;
+}
+
+TEST(test_layer_setting_env, vlGetLayerSettingValues_EmptyElements) {
+    SetEnv("VK_LUNARG_TEST_MY_INTS", "76,,-82,");
+    SetEnv("VK_LUNARG_TEST_MY_BOOLS", "true,,1");
+    SetEnv("VK_LUNARG_TEST_MY_FLOATS", ",1.5");
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, CountEmptyElementsMessage);
+
+    SetEnv("VK_LUNARG_TEST_MY_INTS", nullptr);
+    SetEnv("VK_LUNARG_TEST_MY_BOOLS", nullptr);
+    SetEnv("VK_LUNARG_TEST_MY_FLOATS", nullptr);
+
+    // An empty element is 0, the trailing delimiter doesn't add an element
+    std::vector<std::int32_t> int_values(3);
+    uint32_t value_count = 3;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_ints", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &int_values[0]));
+    EXPECT_EQ(3, value_count);
+    EXPECT_EQ(std::vector<std::int32_t>({76, 0, -82}), int_values);
+
+    std::vector<VkBool32> bool_values(3);
+    value_count = 3;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_bools", VK_LAYER_SETTING_TYPE_BOOL_EXT, &value_count, &bool_values[0]));
+    EXPECT_EQ(std::vector<VkBool32>({VK_TRUE, VK_FALSE, VK_TRUE}), bool_values);
+
+    std::vector<float> float_values(2);
+    value_count = 2;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_floats", VK_LAYER_SETTING_TYPE_FLOAT_EXT, &value_count, &float_values[0]));
+    EXPECT_EQ(std::vector<float>({0.0f, 1.5f}), float_values);
+
+    // Not reported as invalid values
+    vlFlushLayerSettingsLog();
+    EXPECT_EQ(0u, empty_elements_message_count.load());
+
+    vlDestroyLayerSettings();
+}
+
+TEST(test_layer_setting_env, vlGetLayerSettingValues_TrimVendor) {
+    SetEnv("VK_TEST_MY_SETTING", "76");
+    SetEnv("VK_LUNARG_TEST_MY_OTHER_SETTING", "");
+    SetEnv("VK_TEST_MY_OTHER_SETTING", "82");
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+    SetEnv("VK_TEST_MY_SETTING", nullptr);
+    SetEnv("VK_LUNARG_TEST_MY_OTHER_SETTING", nullptr);
+    SetEnv("VK_TEST_MY_OTHER_SETTING", nullptr);
+
+    EXPECT_TRUE(vlHasLayerSetting("my_setting"));
+    EXPECT_TRUE(vlHasLayerSetting("my_other_setting"));
+
+    std::int32_t value = 0;
+    uint32_t value_count = 1;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &value));
+    EXPECT_EQ(76, value);
+
+    // An empty variable is overridden by the next variable by order of precedence
+    value_count = 1;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_other_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &value));
+    EXPECT_EQ(82, value);
+}
+
+TEST(test_layer_setting_env, vlGetLayerSettingValues_OverrideFile) {
+    SetEnv("VK_LUNARG_TEST_MY_SETTING", "76");
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+    test_helper_SetLayerSetting("lunarg_test.my_setting", "82");
+
+    SetEnv("VK_LUNARG_TEST_MY_SETTING", nullptr);
+
+    std::int32_t value = 0;
+    uint32_t value_count = 1;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &value));
+    EXPECT_EQ(76, value);
+
+    // The setting name is upper cased to build the environment variable name
+    value = 0;
+    value_count = 1;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("My_Setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &value));
+    EXPECT_EQ(76, value);
+}
+
+TEST(test_layer_setting_env, vlGetLayerSettingHandle_UpperCase) {
+    for (int i = 0; i < 40; ++i) {
+        SetEnv(("VK_LUNARG_TEST_LATE_SETTING_" + std::to_string(i)).c_str(), std::to_string(i).c_str());
+    }
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+    for (int i = 0; i < 40; ++i) {
+        SetEnv(("VK_LUNARG_TEST_LATE_SETTING_" + std::to_string(i)).c_str(), nullptr);
+    }
+
+    // The settings queried with upper case characters are resolved one by one, their handles remain valid as more are
+    std::vector<VlLayerSettingHandle> handles;
+    for (int i = 0; i < 40; ++i) {
+        const std::string setting_name = "Late_Setting_" + std::to_string(i);
+        handles.push_back(vlGetLayerSettingHandle(setting_name.c_str()));
+        ASSERT_NE(VL_NULL_LAYER_SETTING_HANDLE, handles.back());
+        EXPECT_EQ(handles.back(), vlGetLayerSettingHandle(setting_name.c_str()));
+    }
+
+    for (int i = 0; i < 40; ++i) {
+        int32_t value = -1;
+        uint32_t value_count = 1;
+        EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValuesByHandle(handles[i], VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &value));
+        EXPECT_EQ(i, value);
+    }
+}
+
+TEST(test_layer_setting_env, vlHasLayerSetting_OtherLayer) {
+    SetEnv("VK_KHRONOS_OTHER_MY_SETTING", "76");
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+    SetEnv("VK_KHRONOS_OTHER_MY_SETTING", nullptr);
+
+    EXPECT_FALSE(vlHasLayerSetting("my_setting"));
+}
+
+TEST(test_layer_setting_env, vlGetLayerSettingValues_SettingsPath) {
+    const char* pFilename = "test_layer_setting_env_settings.txt";
+    {
+        std::ofstream file(pFilename, std::ios::binary);
+        file << "# Comment = not a setting\n";
+        file << "lunarg_test.my_setting = 76,-82 # Trailing comment\r\n";
+        file << "lunarg_test.no_value\n";
+        file << "  lunarg_test.empty_setting=\n";
+        file << "lunarg_test.last_setting = first\n";
+        file << "lunarg_test.last_setting = last";
+    }
+
+    SetEnv("XDG_DATA_HOME", "/nonexistent");
+    SetEnv("VK_LAYER_SETTINGS_PATH", pFilename);
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+    SetEnv("VK_LAYER_SETTINGS_PATH", nullptr);
+    SetEnv("XDG_DATA_HOME", nullptr);
+    std::remove(pFilename);
+
+    EXPECT_TRUE(vlHasLayerSetting("my_setting"));
+    EXPECT_TRUE(vlHasLayerSetting("empty_setting"));
+    EXPECT_FALSE(vlHasLayerSetting("no_value"));
+
+    std::vector<int32_t> values(2);
+    uint32_t value_count = 2;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &values[0]));
+    EXPECT_EQ(76, values[0]);
+    EXPECT_EQ(-82, values[1]);
+
+    const char* pValue = nullptr;
+    value_count = 1;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("last_setting", VK_LAYER_SETTING_TYPE_STRING_EXT, &value_count, &pValue));
+    EXPECT_STREQ("last", pValue);
+}
+
+TEST(test_layer_setting_env, vlGetLayerSettingValues_SettingsCache) {
+    const char* pFilename = "test_layer_setting_env_cached.txt";
+    {
+        std::ofstream file(pFilename, std::ios::binary);
+        file << "lunarg_test.my_setting = 76,-82\n";
+    }
+
+    SetEnv("XDG_DATA_HOME", "/nonexistent");
+    SetEnv("VK_LAYER_SETTINGS_PATH", pFilename);
+
+    // The first initialization parses the settings file and writes the cache, the second one reads the cache
+    std::vector<int32_t> values(2);
+    for (int i = 0; i < 2; ++i) {
+        vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+        uint32_t value_count = 2;
+        EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &values[0]));
+        EXPECT_EQ(76, values[0]);
+        EXPECT_EQ(-82, values[1]);
+    }
+
+    // A modified settings file invalidates the cache
+    {
+        std::ofstream file(pFilename, std::ios::binary);
+        file << "lunarg_test.my_setting = 1\n";
+    }
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+    SetEnv("VK_LAYER_SETTINGS_PATH", nullptr);
+    SetEnv("XDG_DATA_HOME", nullptr);
+    std::remove(pFilename);
+
+    uint32_t value_count = 0;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, nullptr));
+    EXPECT_EQ(1, value_count);
+}
+
+TEST(test_layer_setting_env, vlGetLayerSettingValues_SettingsCacheDisabled) {
+    const char* pFilename = "test_layer_setting_env_uncached.txt";
+    {
+        std::ofstream file(pFilename, std::ios::binary);
+        file << "lunarg_test.my_setting = 76,-82\n";
+    }
+
+    SetEnv("XDG_DATA_HOME", "/nonexistent");
+    SetEnv("VK_LAYER_SETTINGS_PATH", pFilename);
+
+    // A disabled cache is not written, nor is a missing cache directory created
+    const std::string cache_home = settings_cache_directory.GetPath() + "/disabled";
+    std::filesystem::create_directories(cache_home);
+    SetEnv("XDG_CACHE_HOME", cache_home.c_str());
+    SetEnv("VK_LAYER_SETTINGS_CACHE", "0");
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+    EXPECT_TRUE(std::filesystem::is_empty(cache_home));
+
+    const std::string missing_cache_home = settings_cache_directory.GetPath() + "/missing";
+    SetEnv("XDG_CACHE_HOME", missing_cache_home.c_str());
+    SetEnv("VK_LAYER_SETTINGS_CACHE", nullptr);
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+    EXPECT_FALSE(std::filesystem::exists(missing_cache_home));
+
+    SetEnv("XDG_CACHE_HOME", settings_cache_directory.GetPath().c_str());
+    SetEnv("VK_LAYER_SETTINGS_PATH", nullptr);
+    SetEnv("XDG_DATA_HOME", nullptr);
+    std::remove(pFilename);
+
+    std::vector<int32_t> values(2);
+    uint32_t value_count = 2;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &values[0]));
+    EXPECT_EQ(76, values[0]);
+    EXPECT_EQ(-82, values[1]);
+}
+
+TEST(test_layer_setting_env, vlCreateLayerSettingSet_SharedFile) {
+    const char* pFilename = "test_layer_setting_env_shared.txt";
+    {
+        std::ofstream file(pFilename, std::ios::binary);
+        file << "lunarg_test.my_setting = 76,-82\n";
+        file << "lunarg_test.file_setting = VALUE\n";
+    }
+
+    SetEnv("XDG_DATA_HOME", "/nonexistent");
+    SetEnv("VK_LAYER_SETTINGS_PATH", pFilename);
+    SetEnv("VK_LUNARG_TEST_ENV_SETTING", "1");
+
+    std::vector<std::int32_t> input_values{11};
+    std::vector<VkLayerSettingEXT> settings{
+        {"VK_LAYER_LUNARG_test", "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, static_cast<uint32_t>(input_values.size()), {&input_values[0]}}};
+
+    VkLayerSettingsCreateInfoEXT layer_settings_create_info{
+        VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, static_cast<uint32_t>(settings.size()), &settings[0]};
+
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &layer_settings_create_info;
+
+    VlLayerSettingSet set_a = nullptr;
+    VlLayerSettingSet set_b = nullptr;
+    EXPECT_EQ(VK_SUCCESS, vlCreateLayerSettingSet("VK_LAYER_LUNARG_test", nullptr, nullptr, nullptr, &set_a));
+    EXPECT_EQ(VK_SUCCESS, vlCreateLayerSettingSet("VK_LAYER_LUNARG_test", &instance_create_info, nullptr, nullptr, &set_b));
+
+    SetEnv("VK_LUNARG_TEST_ENV_SETTING", nullptr);
+    SetEnv("VK_LAYER_SETTINGS_PATH", nullptr);
+    SetEnv("XDG_DATA_HOME", nullptr);
+    std::remove(pFilename);
+
+    // Both sets use the same vk_layer_settings.txt values
+    const char* pValue_a = nullptr;
+    const char* pValue_b = nullptr;
+    uint32_t value_count = 1;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingSetValues(set_a, "file_setting", VK_LAYER_SETTING_TYPE_STRING_EXT, &value_count, &pValue_a));
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingSetValues(set_b, "file_setting", VK_LAYER_SETTING_TYPE_STRING_EXT, &value_count, &pValue_b));
+    EXPECT_STREQ("VALUE", pValue_a);
+    EXPECT_STREQ("VALUE", pValue_b);
+
+    EXPECT_TRUE(vlHasLayerSettingInSet(set_a, "env_setting"));
+    EXPECT_TRUE(vlHasLayerSettingInSet(set_b, "env_setting"));
+
+    // The file overrides the VK_EXT_layer_settings values of the second set only
+    std::vector<std::int32_t> values(2);
+    value_count = 2;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingSetValues(set_b, "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &values[0]));
+    EXPECT_EQ(76, values[0]);
+    EXPECT_EQ(-82, values[1]);
+
+    vlDestroyLayerSettingSet(set_a);
+    vlDestroyLayerSettingSet(set_b);
+}
+
+TEST(test_layer_setting_env, vlSetLayerSettingsHotReload) {
+    const char* pFilename = "test_layer_setting_env_hot_reload.txt";
+    {
+        std::ofstream file(pFilename, std::ios::binary);
+        file << "lunarg_test.reload_setting = 1\n";
+    }
+
+    SetEnv("XDG_DATA_HOME", "/nonexistent");
+    SetEnv("VK_LAYER_SETTINGS_PATH", pFilename);
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+    auto get_value = []() {
+        int32_t value = 0;
+        uint32_t value_count = 1;
+        vlGetLayerSettingValues("reload_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &value);
+        return value;
+    };
+    EXPECT_EQ(1, get_value());
+
+    const uint64_t generation = vlGetLayerSettingsGeneration();
+    EXPECT_EQ(VK_SUCCESS, vlSetLayerSettingsHotReload(VK_TRUE));
+    EXPECT_LT(generation, vlGetLayerSettingsGeneration());
+
+    // The file is modified in place, the new value is published by the watcher thread
+    {
+        std::ofstream file(pFilename, std::ios::binary | std::ios::trunc);
+        file << "lunarg_test.reload_setting = 22\n";
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (get_value() != 22 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(22, get_value());
+
+    EXPECT_EQ(VK_SUCCESS, vlSetLayerSettingsHotReload(VK_FALSE));
+
+    SetEnv("VK_LAYER_SETTINGS_PATH", nullptr);
+    SetEnv("XDG_DATA_HOME", nullptr);
+    std::remove(pFilename);
+}
+
+#if !defined(_WIN32)
+TEST(test_layer_setting_env, vlSetLayerSettingsHotReload_NewFile) {
+    const char* pFilename = "test_layer_setting_env_hot_reload_new_file.txt";
+    {
+        std::ofstream file(pFilename, std::ios::binary);
+        file << "lunarg_test.reload_setting = 1\n";
+    }
+
+    // The settings store directory exists, without a settings file yet
+    const std::string data_home = settings_cache_directory.GetPath() + "/data";
+    const std::string store_directory = data_home + "/vulkan/settings.d";
+    std::filesystem::create_directories(store_directory);
+
+    SetEnv("XDG_DATA_HOME", data_home.c_str());
+    SetEnv("VK_LAYER_SETTINGS_PATH", pFilename);
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+    auto get_value = []() {
+        int32_t value = 0;
+        uint32_t value_count = 1;
+        vlGetLayerSettingValues("reload_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &value);
+        return value;
+    };
+    EXPECT_EQ(1, get_value());
+    EXPECT_EQ(VK_SUCCESS, vlSetLayerSettingsHotReload(VK_TRUE));
+
+    // The reloads use the environment of vlInitLayerSettings
+    SetEnv("XDG_DATA_HOME", "/nonexistent");
+
+    // The settings file of the store takes precedence over VK_LAYER_SETTINGS_PATH once it is created
+    {
+        std::ofstream file(store_directory + "/vk_layer_settings.txt", std::ios::binary);
+        file << "lunarg_test.reload_setting = 33\n";
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (get_value() != 33 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(33, get_value());
+
+    EXPECT_EQ(VK_SUCCESS, vlSetLayerSettingsHotReload(VK_FALSE));
+
+    SetEnv("VK_LAYER_SETTINGS_PATH", nullptr);
+    SetEnv("XDG_DATA_HOME", nullptr);
+    std::remove(pFilename);
+}
+#endif
+
+TEST(test_layer_setting_env, vlSetLayerSettingsHotReload_StaleHandle) {
+    const char* pFilename = "test_layer_setting_env_hot_reload_handle.txt";
+    {
+        std::ofstream file(pFilename, std::ios::binary);
+        file << "lunarg_test.b_setting = 2\n";
+    }
+
+    SetEnv("XDG_DATA_HOME", "/nonexistent");
+    SetEnv("VK_LAYER_SETTINGS_PATH", pFilename);
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+    EXPECT_EQ(VK_SUCCESS, vlSetLayerSettingsHotReload(VK_TRUE));
+
+    const VlLayerSettingHandle handle = vlGetLayerSettingHandle("b_setting");
+    EXPECT_NE(VL_NULL_LAYER_SETTING_HANDLE, handle);
+
+    // The new setting takes the place of the previous first setting
+    const uint64_t generation = vlGetLayerSettingsGeneration();
+    {
+        std::ofstream file(pFilename, std::ios::binary | std::ios::trunc);
+        file << "lunarg_test.a_setting = 1\nlunarg_test.b_setting = 22\n";
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!vlHasLayerSetting("a_setting") && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_LT(generation, vlGetLayerSettingsGeneration());
+
+    // The handle found before the reload doesn't return the values of "a_setting"
+    int32_t value = 0;
+    uint32_t value_count = 1;
+    EXPECT_EQ(VK_ERROR_INITIALIZATION_FAILED,
+              vlGetLayerSettingValuesByHandle(handle, VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &value));
+    EXPECT_EQ(0, value_count);
+
+    const VlLayerSettingHandle new_handle = vlGetLayerSettingHandle("b_setting");
+    value_count = 1;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValuesByHandle(new_handle, VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &value));
+    EXPECT_EQ(22, value);
+
+    EXPECT_EQ(VK_SUCCESS, vlSetLayerSettingsHotReload(VK_FALSE));
+
+    SetEnv("VK_LAYER_SETTINGS_PATH", nullptr);
+    SetEnv("XDG_DATA_HOME", nullptr);
+    std::remove(pFilename);
+}
+
+TEST(test_layer_setting_env, vlSetLayerSettingsHotReload_ApiSettings) {
+    const char* pFilename = "test_layer_setting_env_hot_reload_api.txt";
+    {
+        std::ofstream file(pFilename, std::ios::binary);
+        file << "lunarg_test.file_setting = 1\n";
+    }
+
+    SetEnv("XDG_DATA_HOME", "/nonexistent");
+    SetEnv("VK_LAYER_SETTINGS_PATH", pFilename);
+
+    // The VK_EXT_layer_settings structures of the application are freed once the instance is created
+    {
+        std::vector<std::string> setting_names{"api_setting", "string_setting"};
+        std::vector<std::int32_t> int_values{76, -82};
+        std::vector<std::string> strings{"VALUE_A", "VALUE_B"};
+        std::vector<const char*> string_values{strings[0].c_str(), strings[1].c_str()};
+        std::vector<VkLayerSettingEXT> settings{
+            {"VK_LAYER_LUNARG_test", setting_names[0].c_str(), VK_LAYER_SETTING_TYPE_INT32_EXT,
+             static_cast<uint32_t>(int_values.size()), {&int_values[0]}},
+            {"VK_LAYER_LUNARG_test", setting_names[1].c_str(), VK_LAYER_SETTING_TYPE_STRING_EXT,
+             static_cast<uint32_t>(string_values.size()), {&string_values[0]}}};
+        VkLayerSettingsCreateInfoEXT create_info{VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr,
+                                                 static_cast<uint32_t>(settings.size()), &settings[0]};
+        VkInstanceCreateInfo instance_create_info{};
+        instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        instance_create_info.pNext = &create_info;
+
+        vlInitLayerSettings("VK_LAYER_LUNARG_test", &instance_create_info, nullptr);
+
+        for (std::string& setting_name : setting_names) setting_name.assign(setting_name.size(), 'x');
+        for (std::string& string : strings) string.assign(string.size(), 'x');
+        int_values.assign(int_values.size(), 0);
+        settings.assign(settings.size(), VkLayerSettingEXT{});
+    }
+
+    EXPECT_EQ(VK_SUCCESS, vlSetLayerSettingsHotReload(VK_TRUE));
+
+    {
+        std::ofstream file(pFilename, std::ios::binary | std::ios::trunc);
+        file << "lunarg_test.file_setting = 2\n";
+    }
+
+    auto get_file_value = []() {
+        int32_t value = 0;
+        uint32_t value_count = 1;
+        vlGetLayerSettingValues("file_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &value);
+        return value;
+    };
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (get_file_value() != 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(2, get_file_value());
+
+    // The reloaded layer settings use the copy of the VK_EXT_layer_settings values
+    std::vector<std::int32_t> values(2);
+    uint32_t value_count = 2;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("api_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &values[0]));
+    EXPECT_EQ(76, values[0]);
+    EXPECT_EQ(-82, values[1]);
+
+    std::vector<const char*> string_values(2);
+    value_count = 2;
+    EXPECT_EQ(VK_SUCCESS,
+              vlGetLayerSettingValues("string_setting", VK_LAYER_SETTING_TYPE_STRING_EXT, &value_count, &string_values[0]));
+    EXPECT_STREQ("VALUE_A", string_values[0]);
+    EXPECT_STREQ("VALUE_B", string_values[1]);
+
+    EXPECT_EQ(VK_SUCCESS, vlSetLayerSettingsHotReload(VK_FALSE));
+
+    SetEnv("VK_LAYER_SETTINGS_PATH", nullptr);
+    SetEnv("XDG_DATA_HOME", nullptr);
+    std::remove(pFilename);
+}
@@ -21,10 +21,14 @@
 #include <gtest/gtest.h>
 
 #include "vulkan/layer/vk_layer_settings.h"
+#include "test_setting_cache.hpp"
 #include <vector>
+#include <string>
 
 void test_helper_SetLayerSetting(const char* pSettingName, const char* pValue);
 
+static const TestSettingsCacheDirectory settings_cache_directory;
+
 TEST(test_layer_setting_file, vlGetLayerSettingValues_Bool) {
     vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
 
@@ -289,3 +293,237 @@ TEST(test_layer_setting_file, vlGetLayerSettingValues_String) {
     EXPECT_STREQ("VALUE_B", values[1]);
     EXPECT_EQ(2, value_count);
 }
+
+TEST(test_layer_setting_file, vlGetLayerSettingValues_OverrideAPI) {
+    std::vector<std::int32_t> input_values{76, -82, 11};
+
+    std::vector<VkLayerSettingEXT> settings{
+        {"VK_LAYER_LUNARG_test", "my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, static_cast<uint32_t>(input_values.size()), {&input_values[0]}},
+        {"VK_LAYER_LUNARG_test", "api_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, static_cast<uint32_t>(input_values.size()), {&input_values[0]}}};
+
+    VkLayerSettingsCreateInfoEXT layer_settings_create_info{
+        VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, static_cast<uint32_t>(settings.size()), &settings[0]};
+
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &layer_settings_create_info;
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", &instance_create_info, nullptr);
+
+    test_helper_SetLayerSetting("lunarg_test.my_setting", "1,2");
+
+    EXPECT_TRUE(vlHasLayerSetting("my_setting"));
+    EXPECT_TRUE(vlHasLayerSetting("api_setting"));
+    EXPECT_FALSE(vlHasLayerSetting("missing_setting"));
+
+    uint32_t value_count = 0;
+    VkResult result_count = vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, nullptr);
+    EXPECT_EQ(VK_SUCCESS, result_count);
+    EXPECT_EQ(2, value_count);
+
+    std::vector<std::int32_t> values(static_cast<uint32_t>(value_count));
+    VkResult result_complete = vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, &values[0]);
+    EXPECT_EQ(VK_SUCCESS, result_complete);
+    EXPECT_EQ(1, values[0]);
+    EXPECT_EQ(2, values[1]);
+
+    value_count = 0;
+    result_count = vlGetLayerSettingValues("api_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, &value_count, nullptr);
+    EXPECT_EQ(VK_SUCCESS, result_count);
+    EXPECT_EQ(3, value_count);
+}
+
+TEST(test_layer_setting_file, vlGetLayerSettingValues_Cache) {
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+    test_helper_SetLayerSetting("lunarg_test.my_setting", "VALUE_A,VALUE_B");
+
+    std::vector<const char*> values_first(2);
+    std::vector<const char*> values_second(2);
+
+    uint32_t value_count = 2;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_STRING_EXT, &value_count, &values_first[0]));
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_STRING_EXT, &value_count, &values_second[0]));
+
+    // Strings returned by a previous query remain valid
+    EXPECT_EQ(values_first[0], values_second[0]);
+    EXPECT_EQ(values_first[1], values_second[1]);
+    EXPECT_STREQ("VALUE_A", values_first[0]);
+    EXPECT_STREQ("VALUE_B", values_first[1]);
+
+    // The same values are parsed for each type
+    std::vector<VkBool32> bool_values(2);
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_BOOL_EXT, &value_count, &bool_values[0]));
+    EXPECT_EQ(VK_FALSE, bool_values[0]);
+    EXPECT_EQ(VK_FALSE, bool_values[1]);
+}
+
+static std::vector<std::string> logged_messages;
+
+static void *LogCallback(const char *pSettingName, const char *pMessage) {
+    (void)pSettingName;
+    logged_messages.push_back(pMessage);
+    return nullptr;
+}
+
+TEST(test_layer_setting_file, vlGetLayerSettingValues_OutOfRange) {
+    logged_messages.clear();
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, LogCallback);
+
+    test_helper_SetLayerSetting("lunarg_test.my_setting", "0xFF,4294967296,-1,12");
+
+    uint32_t value_count = 4;
+    std::vector<uint32_t> values(value_count);
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_UINT32_EXT, &value_count, &values[0]));
+    EXPECT_EQ(std::vector<uint32_t>({255, 0, 0, 12}), values);
+
+    vlFlushLayerSettingsLog();
+    ASSERT_EQ(2, logged_messages.size());
+    EXPECT_STREQ("The data provided (4294967296) at index 1 is out of the range of uint32_t values.", logged_messages[0].c_str());
+    EXPECT_STREQ("The data provided (-1) at index 2 is out of the range of uint32_t values.", logged_messages[1].c_str());
+}
+
+TEST(test_layer_setting_file, vlIsFrameInLayerSettingFrameset) {
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+    test_helper_SetLayerSetting("lunarg_test.my_setting", "0,76-100-10,5-3");
+
+    VlLayerSettingHandle handle = vlGetLayerSettingHandle("my_setting");
+
+    EXPECT_TRUE(vlIsFrameInLayerSettingFrameset(handle, 0));
+    EXPECT_FALSE(vlIsFrameInLayerSettingFrameset(handle, 1));
+    EXPECT_TRUE(vlIsFrameInLayerSettingFrameset(handle, 7));
+    EXPECT_FALSE(vlIsFrameInLayerSettingFrameset(handle, 8));
+    EXPECT_TRUE(vlIsFrameInLayerSettingFrameset(handle, 86));
+    EXPECT_FALSE(vlIsFrameInLayerSettingFrameset(handle, 87));
+    EXPECT_TRUE(vlIsFrameInLayerSettingFrameset(handle, 1066));
+    EXPECT_FALSE(vlIsFrameInLayerSettingFrameset(handle, 1076));
+}
+
+TEST(test_layer_setting_file, vlGetLayerSettingValues_String_EmptyValues) {
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+    test_helper_SetLayerSetting("lunarg_test.my_setting", "VALUE_A,,VALUE_C,");
+
+    uint32_t value_count = 0;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_STRING_EXT, &value_count, nullptr));
+    EXPECT_EQ(3, value_count);
+
+    std::vector<const char*> values(value_count);
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValues("my_setting", VK_LAYER_SETTING_TYPE_STRING_EXT, &value_count, &values[0]));
+    EXPECT_STREQ("VALUE_A", values[0]);
+    EXPECT_STREQ("", values[1]);
+    EXPECT_STREQ("VALUE_C", values[2]);
+}
+
+TEST(test_layer_setting_file, vlGetLayerSettingValuesBatch) {
+    std::vector<std::int32_t> input_values{76, -82, 11};
+
+    std::vector<VkLayerSettingEXT> settings{
+        {"VK_LAYER_LUNARG_test", "api_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, static_cast<uint32_t>(input_values.size()), {&input_values[0]}}};
+
+    VkLayerSettingsCreateInfoEXT layer_settings_create_info{
+        VK_STRUCTURE_TYPE_LAYER_SETTINGS_EXT, nullptr, static_cast<uint32_t>(settings.size()), &settings[0]};
+
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &layer_settings_create_info;
+
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", &instance_create_info, nullptr);
+
+    test_helper_SetLayerSetting("lunarg_test.my_setting", "VALUE_A,VALUE_B");
+    test_helper_SetLayerSetting("lunarg_test.my_bool", "true");
+    test_helper_SetLayerSetting("lunarg_test.my_empty", "");
+
+    std::vector<const char*> string_values(2);
+    std::vector<std::int32_t> int_values(2);
+    VkBool32 bool_value = VK_FALSE;
+
+    std::vector<VlLayerSettingValuesQuery> queries{
+        {"my_setting", VK_LAYER_SETTING_TYPE_STRING_EXT, 2, &string_values[0], 0, VK_ERROR_UNKNOWN},
+        {"api_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, 2, &int_values[0], 0, VK_ERROR_UNKNOWN},
+        {"my_bool", VK_LAYER_SETTING_TYPE_BOOL_EXT, 1, &bool_value, 0, VK_ERROR_UNKNOWN},
+        {"my_bool", VK_LAYER_SETTING_TYPE_BOOL_EXT, 0, nullptr, 0, VK_ERROR_UNKNOWN},
+        {"my_empty", VK_LAYER_SETTING_TYPE_STRING_EXT, 0, nullptr, 0, VK_ERROR_UNKNOWN},
+        {"missing_setting", VK_LAYER_SETTING_TYPE_INT32_EXT, 0, nullptr, 0, VK_ERROR_UNKNOWN}};
+
+    EXPECT_EQ(VK_INCOMPLETE, vlGetLayerSettingValuesBatch(static_cast<uint32_t>(queries.size()), &queries[0]));
+
+    EXPECT_EQ(VK_SUCCESS, queries[0].result);
+    EXPECT_EQ(2, queries[0].valueCount);
+    EXPECT_STREQ("VALUE_A", string_values[0]);
+    EXPECT_STREQ("VALUE_B", string_values[1]);
+
+    // The values don't fit the capacity: the count is the number of values of the setting
+    EXPECT_EQ(VK_INCOMPLETE, queries[1].result);
+    EXPECT_EQ(3, queries[1].valueCount);
+    EXPECT_EQ(76, int_values[0]);
+    EXPECT_EQ(-82, int_values[1]);
+
+    EXPECT_EQ(VK_SUCCESS, queries[2].result);
+    EXPECT_EQ(1, queries[2].valueCount);
+    EXPECT_EQ(VK_TRUE, bool_value);
+
+    // Count only
+    EXPECT_EQ(VK_SUCCESS, queries[3].result);
+    EXPECT_EQ(1, queries[3].valueCount);
+
+    // Same results as vlGetLayerSettingValues
+    EXPECT_EQ(VK_INCOMPLETE, queries[4].result);
+    EXPECT_EQ(0, queries[4].valueCount);
+
+    EXPECT_EQ(VK_SUCCESS, queries[5].result);
+    EXPECT_EQ(0, queries[5].valueCount);
+
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValuesBatch(0, nullptr));
+}
+
+TEST(test_layer_setting_file, vlLayerSettingContains) {
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, nullptr);
+
+    test_helper_SetLayerSetting("lunarg_test.my_setting", "0x4dae5635,VUID-vkCmdDraw-None-02699");
+    test_helper_SetLayerSetting("lunarg_test.my_empty", "");
+
+    VlLayerSettingHandle handle = vlGetLayerSettingHandle("my_setting");
+    EXPECT_NE(VL_NULL_LAYER_SETTING_HANDLE, handle);
+
+    EXPECT_TRUE(vlLayerSettingContains(handle, "0x4dae5635"));
+    EXPECT_TRUE(vlLayerSettingContains(handle, "VUID-vkCmdDraw-None-02699"));
+    EXPECT_FALSE(vlLayerSettingContains(handle, "0x4dae5635,VUID-vkCmdDraw-None-02699"));
+
+    // The strings queried before and after building the set remain the same
+    std::vector<const char*> values(2);
+    uint32_t value_count = 2;
+    EXPECT_EQ(VK_SUCCESS, vlGetLayerSettingValuesByHandle(handle, VK_LAYER_SETTING_TYPE_STRING_EXT, &value_count, &values[0]));
+    EXPECT_STREQ("0x4dae5635", values[0]);
+
+    EXPECT_FALSE(vlLayerSettingContains(vlGetLayerSettingHandle("my_empty"), ""));
+}
+
+TEST(test_layer_setting_file, vlGetLayerSettingFlags) {
+    const VlLayerSettingFlagInfo flags[] = {{"error", 0x1}, {"warn", 0x2}, {"perf", 0x4}, {"all", 0x7}};
+
+    vlRegisterLayerSettingFlags("my_flags", 4, flags);
+
+    logged_messages.clear();
+    vlInitLayerSettings("VK_LAYER_LUNARG_test", nullptr, LogCallback);
+
+    test_helper_SetLayerSetting("lunarg_test.my_flags", "error,perf,unknown");
+
+    VlLayerSettingHandle handle = vlGetLayerSettingHandle("my_flags");
+    EXPECT_NE(VL_NULL_LAYER_SETTING_HANDLE, handle);
+    EXPECT_EQ(0x5, vlGetLayerSettingFlags(handle));
+
+    vlFlushLayerSettingsLog();
+    ASSERT_EQ(1, logged_messages.size());
+    EXPECT_STREQ("The data provided (unknown) at index 2 is not a known flag.", logged_messages[0].c_str());
+
+    // Registering the flags again resolves the values immediately
+    vlRegisterLayerSettingFlags("my_flags", 3, flags);
+    EXPECT_EQ(0x5, vlGetLayerSettingFlags(handle));
+
+    EXPECT_EQ(0, vlGetLayerSettingFlags(VL_NULL_LAYER_SETTING_HANDLE));
+
+    vlRegisterLayerSettingFlags("my_flags", 0, nullptr);
+}
+
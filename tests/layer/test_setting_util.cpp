@@ -19,10 +19,34 @@
  */
 
 #include "layer_settings_util.hpp"
+#include "layer_settings_arena.hpp"
+#include "layer_settings_convert.hpp"
+#include "layer_settings_file.hpp"
+#include "layer_settings_frameset.hpp"
+#include "layer_settings_string_set.hpp"
+#include "layer_settings_rcu.hpp"
+#include "layer_settings_log.hpp"
+#include "test_setting_cache.hpp"
 
 #include <gtest/gtest.h>
 #include <vulkan/vulkan.h>
 
+#include <regex>
+#include <limits>
+#include <utility>
+#include <map>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+
+static const TestSettingsCacheDirectory settings_cache_directory;
+
 TEST(test_layer_settings_util, FindSettingsInChain_found_first) {
     VkDebugReportCallbackCreateInfoEXT debugReportCallbackCreateInfo{};
     debugReportCallbackCreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CALLBACK_CREATE_INFO_EXT;
@@ -132,6 +156,23 @@ TEST(test_layer_settings_util, Split_0Value) {
     EXPECT_EQ(0, result.size());
 }
 
+TEST(test_layer_settings_util, Tokenizer) {
+    const std::vector<std::string> values{"", ",", "A", "A,", ",A", "A,B", "A,,B", "A,B,", "A,B,,", ",,"};
+
+    for (const std::string &value : values) {
+        const std::vector<std::string> &split = vl::Split(value, ',');
+        EXPECT_EQ(split.size(), vl::CountTokens(value, ',')) << value;
+
+        std::vector<std::string> tokens;
+        vl::Tokenizer tokenizer(value, ',');
+        for (std::string_view token; tokenizer.Next(token);) {
+            EXPECT_TRUE(token.data() >= value.data() && token.data() + token.size() <= value.data() + value.size());
+            tokens.emplace_back(token);
+        }
+        EXPECT_EQ(split, tokens) << value;
+    }
+}
+
 TEST(test_layer_settings_util, TrimWhitespace_NoWhitespace) {
     std::string value("VALUE_A-VALUE_B");
     std::string result = vl::TrimWhitespace(value);
@@ -331,6 +372,347 @@ TEST(test_layer_settings_util, is_float) {
     EXPECT_EQ(false, vl::IsFloat("A"));
 }
 
+TEST(test_layer_settings_util, ConvertInteger) {
+    int32_t value_int32 = 0;
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertInt32("-82", value_int32));
+    EXPECT_EQ(-82, value_int32);
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertInt32("0x1F", value_int32));
+    EXPECT_EQ(31, value_int32);
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertInt32("-0X3ac7E", value_int32));
+    EXPECT_EQ(-0x3AC7E, value_int32);
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertInt32("-2147483648", value_int32));
+    EXPECT_EQ(std::numeric_limits<int32_t>::min(), value_int32);
+    EXPECT_EQ(vl::CONVERT_ERROR_OUT_OF_RANGE, vl::ConvertInt32("2147483648", value_int32));
+    EXPECT_EQ(vl::CONVERT_ERROR_OUT_OF_RANGE, vl::ConvertInt32("0x100000000", value_int32));
+    EXPECT_EQ(vl::CONVERT_ERROR_INVALID, vl::ConvertInt32("", value_int32));
+    EXPECT_EQ(vl::CONVERT_ERROR_INVALID, vl::ConvertInt32("-", value_int32));
+    EXPECT_EQ(vl::CONVERT_ERROR_INVALID, vl::ConvertInt32("0x", value_int32));
+    EXPECT_EQ(vl::CONVERT_ERROR_INVALID, vl::ConvertInt32("0x-1", value_int32));
+    EXPECT_EQ(vl::CONVERT_ERROR_INVALID, vl::ConvertInt32("0xG", value_int32));
+    EXPECT_EQ(vl::CONVERT_ERROR_INVALID, vl::ConvertInt32("12a", value_int32));
+
+    int64_t value_int64 = 0;
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertInt64("-9223372036854775808", value_int64));
+    EXPECT_EQ(std::numeric_limits<int64_t>::min(), value_int64);
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertInt64("0x7FFFFFFFFFFFFFFF", value_int64));
+    EXPECT_EQ(std::numeric_limits<int64_t>::max(), value_int64);
+    EXPECT_EQ(vl::CONVERT_ERROR_OUT_OF_RANGE, vl::ConvertInt64("9223372036854775808", value_int64));
+
+    uint32_t value_uint32 = 0;
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertUint32("0xFFFFFFFF", value_uint32));
+    EXPECT_EQ(std::numeric_limits<uint32_t>::max(), value_uint32);
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertUint32("-0", value_uint32));
+    EXPECT_EQ(0u, value_uint32);
+    EXPECT_EQ(vl::CONVERT_ERROR_OUT_OF_RANGE, vl::ConvertUint32("-1", value_uint32));
+    EXPECT_EQ(vl::CONVERT_ERROR_OUT_OF_RANGE, vl::ConvertUint32("4294967296", value_uint32));
+
+    uint64_t value_uint64 = 0;
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertUint64("18446744073709551615", value_uint64));
+    EXPECT_EQ(std::numeric_limits<uint64_t>::max(), value_uint64);
+    EXPECT_EQ(vl::CONVERT_ERROR_OUT_OF_RANGE, vl::ConvertUint64("18446744073709551616", value_uint64));
+}
+
+TEST(test_layer_settings_util, ConvertFloat) {
+    float value_float = 0.0f;
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertFloat("-1.5", value_float));
+    EXPECT_EQ(-1.5f, value_float);
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertFloat("76.25f", value_float));
+    EXPECT_EQ(76.25f, value_float);
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertFloat("1.", value_float));
+    EXPECT_EQ(1.0f, value_float);
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertFloat(".5", value_float));
+    EXPECT_EQ(0.5f, value_float);
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertFloat("-0.f", value_float));
+    EXPECT_EQ(0.0f, value_float);
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertFloat("007", value_float));
+    EXPECT_EQ(7.0f, value_float);
+    EXPECT_EQ(vl::CONVERT_ERROR_OUT_OF_RANGE, vl::ConvertFloat("1" + std::string(39, '0'), value_float));
+    EXPECT_EQ(vl::CONVERT_ERROR_INVALID, vl::ConvertFloat("", value_float));
+    EXPECT_EQ(vl::CONVERT_ERROR_INVALID, vl::ConvertFloat("f", value_float));
+    EXPECT_EQ(vl::CONVERT_ERROR_INVALID, vl::ConvertFloat("1,5", value_float));
+    EXPECT_EQ(vl::CONVERT_ERROR_INVALID, vl::ConvertFloat("A", value_float));
+
+    double value_double = 0.0;
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertDouble("1" + std::string(39, '0'), value_double));
+    EXPECT_EQ(1e39, value_double);
+    EXPECT_EQ(vl::CONVERT_ERROR_OUT_OF_RANGE, vl::ConvertDouble("1" + std::string(400, '0'), value_double));
+}
+
+// The grammar of the floating-point values is -?[0-9]*([.][0-9]*f?)? with at least one digit
+TEST(test_layer_settings_util, ConvertFloat_Grammar) {
+    const char *valid_tokens[] = {"0", "-0", "12", "-12", "1.", "-1.", ".5", "-.5", "1.5", "1.5f", "1.5F", "1.f", ".5f", "-.5f"};
+    for (const char *token : valid_tokens) {
+        double value = 0.0;
+        EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertDouble(token, value)) << token;
+    }
+
+    const char *invalid_tokens[] = {"", "-", ".", "-.", ".f", "f", "1f", "12f", "+1", "--1", "1.5.", "1..5", "1.5ff", "1.5 ",
+                                    " 1.5", "1e3", "1.5e3", "1E3", "1e-3", "0x1p3", "0x10", "inf", "-inf", "INF", "infinity",
+                                    "nan", "-nan", "NaN", "nan(1)", "1.5d"};
+    for (const char *token : invalid_tokens) {
+        double value_double = 0.0;
+        EXPECT_EQ(vl::CONVERT_ERROR_INVALID, vl::ConvertDouble(token, value_double)) << token;
+        float value_float = 0.0f;
+        EXPECT_EQ(vl::CONVERT_ERROR_INVALID, vl::ConvertFloat(token, value_float)) << token;
+    }
+}
+
+TEST(test_layer_settings_util, ConvertBool32) {
+    VkBool32 value = VK_FALSE;
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertBool32("TRUE", value));
+    EXPECT_EQ(VK_TRUE, value);
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertBool32("False", value));
+    EXPECT_EQ(VK_FALSE, value);
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertBool32("0x10", value));
+    EXPECT_EQ(VK_TRUE, value);
+    EXPECT_EQ(vl::CONVERT_SUCCESS, vl::ConvertBool32("0", value));
+    EXPECT_EQ(VK_FALSE, value);
+    EXPECT_EQ(vl::CONVERT_ERROR_INVALID, vl::ConvertBool32("yes", value));
+}
+
+TEST(test_layer_settings_util, ParseSettingsText) {
+    const std::string text =
+        "# Comment = not a setting\n"
+        "lunarg_test.a = 1,2 # Trailing comment\r\n"
+        "\n"
+        "lunarg_test.no_value\n"
+        " \t lunarg_test.b=x=y\n"
+        "lunarg_test.c =\n"
+        "=\n"
+        "lunarg_test.d = last";
+
+    // The values are trimmed only when they are used
+    std::vector<std::pair<std::string_view, std::string_view>> settings;
+    vl::ParseSettingsText(text, [&](std::string_view key, std::string_view value) {
+        settings.emplace_back(key, vl::TrimSettingsValue(value));
+        if (key == "lunarg_test.a") {
+            EXPECT_EQ(" 1,2 ", value);
+        }
+    });
+
+    ASSERT_EQ(5, settings.size());
+    EXPECT_EQ("lunarg_test.a", settings[0].first);
+    EXPECT_EQ("1,2", settings[0].second);
+    EXPECT_EQ("lunarg_test.b", settings[1].first);
+    EXPECT_EQ("x=y", settings[1].second);
+    EXPECT_EQ("lunarg_test.c", settings[2].first);
+    EXPECT_EQ("", settings[2].second);
+    EXPECT_EQ("", settings[3].first);
+    EXPECT_EQ("", settings[3].second);
+    EXPECT_EQ("lunarg_test.d", settings[4].first);
+    EXPECT_EQ("last", settings[4].second);
+}
+
+// Decode the entries indexed by ParseSettingsText
+static std::map<std::string_view, std::string_view> GetSettingsEntryValues(std::string_view text,
+                                                                           const std::vector<vl::SettingsFileEntry> &entries) {
+    const vl::SettingsIndex index{entries.data(), entries.size(), text};
+
+    std::map<std::string_view, std::string_view> values;
+    for (const vl::SettingsFileEntry &entry : index) {
+        EXPECT_TRUE(values.empty() || values.rbegin()->first < index.GetKey(entry));
+        values.emplace(index.GetKey(entry), index.GetValue(entry));
+    }
+    return values;
+}
+
+TEST(test_layer_settings_util, ParseSettingsText_Parallel) {
+    // Keys are repeated across the whole text so that the last occurrence is in another chunk than the first ones
+    std::string text = "lunarg_test.previous = 0\n";
+    for (int i = 0; i < 2000; ++i) {
+        text += "lunarg_test.setting_" + std::to_string(i % 300) + " = " + std::to_string(i) + (i % 7 == 0 ? " # Comment\n" : "\n");
+    }
+    text += "lunarg_test.no_newline = last";
+
+    std::vector<vl::SettingsFileEntry> entries;
+    vl::ParseSettingsText(text, 1, entries);
+    const std::map<std::string_view, std::string_view> expected = GetSettingsEntryValues(text, entries);
+    EXPECT_EQ(302u, expected.size());
+    EXPECT_EQ(std::string_view("0"), expected.at("lunarg_test.previous"));
+    EXPECT_EQ(std::string_view("1999"), expected.at("lunarg_test.setting_199"));
+    EXPECT_EQ(std::string_view("last"), expected.at("lunarg_test.no_newline"));
+
+    for (std::size_t thread_count = 2; thread_count <= 16; ++thread_count) {
+        vl::ParseSettingsText(text, thread_count, entries);
+        EXPECT_EQ(expected, GetSettingsEntryValues(text, entries)) << thread_count << " threads";
+    }
+
+    vl::ParseSettingsText("", 4, entries);
+    EXPECT_TRUE(entries.empty());
+}
+
+#if !defined(_WIN32) && !defined(__ANDROID__)
+TEST(test_layer_settings_util, SettingsCache) {
+    const std::string text = "lunarg_test.a = 1,2\nlunarg_test.b =\n";
+    std::vector<vl::SettingsFileEntry> entries;
+    vl::ParseSettingsText(text, 1, entries);
+    const vl::SettingsIndex index{entries.data(), entries.size(), text};
+
+    vl::FileIdentity identity;
+    identity.size = 42;
+    identity.modification_time = 1234567890123456789;
+    identity.inode = 7;
+    identity.device = 3;
+
+    const std::string cache_filename = settings_cache_directory.GetPath() + "/settings/settings.bin";
+    const char *pCacheFilename = cache_filename.c_str();
+    EXPECT_TRUE(vl::WriteSettingsCache(pCacheFilename, "/path/vk_layer_settings.txt", identity, index));
+
+    vl::MappedFile cache;
+    ASSERT_TRUE(cache.Open(pCacheFilename));
+
+    // The cache is used in place
+    vl::SettingsIndex read_index;
+    EXPECT_TRUE(vl::ReadSettingsCache(cache.GetText(), "/path/vk_layer_settings.txt", identity, read_index));
+    ASSERT_EQ(2u, read_index.entry_count);
+    ASSERT_NE(nullptr, read_index.Find("lunarg_test.a"));
+    EXPECT_EQ("1,2", read_index.GetValue(*read_index.Find("lunarg_test.a")));
+    ASSERT_NE(nullptr, read_index.Find("lunarg_test.b"));
+    EXPECT_EQ("", read_index.GetValue(*read_index.Find("lunarg_test.b")));
+    EXPECT_EQ(nullptr, read_index.Find("lunarg_test.c"));
+
+    // The cache doesn't match another settings file or another version of the settings file
+    vl::SettingsIndex stale_index;
+    EXPECT_FALSE(vl::ReadSettingsCache(cache.GetText(), "/other/vk_layer_settings.txt", identity, stale_index));
+    vl::FileIdentity modified_identity = identity;
+    modified_identity.modification_time += 1;
+    EXPECT_FALSE(vl::ReadSettingsCache(cache.GetText(), "/path/vk_layer_settings.txt", modified_identity, stale_index));
+    EXPECT_EQ(0u, stale_index.entry_count);
+
+    // A truncated cache is rejected
+    const std::string_view cache_text = cache.GetText();
+    for (std::size_t size = 0; size < cache_text.size(); ++size) {
+        EXPECT_FALSE(vl::ReadSettingsCache(cache_text.substr(0, size), "/path/vk_layer_settings.txt", identity, stale_index));
+    }
+
+    cache.Close();
+    std::remove(pCacheFilename);
+
+    // The missing cache directory is not created
+    const std::string missing_directory = settings_cache_directory.GetPath() + "/missing";
+    const std::string missing_filename = missing_directory + "/vulkan/layer_settings/settings.bin";
+    EXPECT_FALSE(vl::WriteSettingsCache(missing_filename.c_str(), "/path/vk_layer_settings.txt", identity, index));
+    EXPECT_FALSE(std::filesystem::exists(missing_directory));
+}
+
+TEST(test_layer_settings_util, GetSettingsCacheFile) {
+    // The cache file is found in the environment captured before the call
+    auto cache_file = [] { return vl::GetSettingsCacheFile("vk_layer_settings.txt", *vl::EnvironmentSnapshot::Capture()); };
+
+    const std::string cache_home = settings_cache_directory.GetPath();
+    EXPECT_EQ(0u, cache_file().rfind(cache_home + "/vulkan/layer_settings/", 0));
+
+    // A relative $XDG_CACHE_HOME is ignored
+    const char *home = std::getenv("HOME");
+    setenv("XDG_CACHE_HOME", "relative_cache", 1);
+    if (home != nullptr && home[0] != '\0') {
+        const std::string home_cache_dir = std::string(home) + "/.cache/vulkan/layer_settings/";
+        EXPECT_EQ(0u, cache_file().rfind(home_cache_dir, 0));
+    }
+    setenv("XDG_CACHE_HOME", cache_home.c_str(), 1);
+
+    // The cache can be disabled, a snapshot isn't affected by the later changes of the environment
+    const std::shared_ptr<const vl::EnvironmentSnapshot> environment = vl::EnvironmentSnapshot::Capture();
+    EXPECT_EQ(environment, vl::EnvironmentSnapshot::Capture());
+    setenv("VK_LAYER_SETTINGS_CACHE", "0", 1);
+    EXPECT_EQ("", cache_file());
+    EXPECT_NE("", vl::GetSettingsCacheFile("vk_layer_settings.txt", *environment));
+    EXPECT_NE(environment, vl::EnvironmentSnapshot::Capture());
+    setenv("VK_LAYER_SETTINGS_CACHE", "false", 1);
+    EXPECT_EQ("", cache_file());
+    setenv("VK_LAYER_SETTINGS_CACHE", "1", 1);
+    EXPECT_NE("", cache_file());
+    unsetenv("VK_LAYER_SETTINGS_CACHE");
+}
+#endif
+
+TEST(test_layer_settings_util, SettingsFile) {
+    const char *pFilename = "test_layer_settings_util_file.txt";
+    {
+        std::ofstream file(pFilename, std::ios::trunc);
+        file << "lunarg_other.a = 0\nlunarg_test.a = 1\nlunarg_test.b = 2\nlunarg_tests.a = 3\n";
+    }
+
+    const std::shared_ptr<const vl::EnvironmentSnapshot> environment = vl::EnvironmentSnapshot::Capture();
+
+    // The file is parsed once for all the layers
+    std::shared_ptr<const vl::SettingsFile> file = vl::SettingsFile::Acquire(pFilename, *environment);
+    EXPECT_EQ(file, vl::SettingsFile::Acquire(pFilename, *environment));
+    EXPECT_EQ(4u, file->GetIndex().entry_count);
+
+    const vl::SettingsFileView test_view(file, "lunarg_test.");
+    const std::map<std::string_view, std::string_view> expected{{"lunarg_test.a", "1"}, {"lunarg_test.b", "2"}};
+    const std::map<std::string_view, std::string_view> view_values(test_view.begin(), test_view.end());
+    EXPECT_EQ(expected, view_values);
+    std::string_view value;
+    EXPECT_TRUE(test_view.Find("lunarg_test.b", value));
+    EXPECT_EQ("2", value);
+    EXPECT_FALSE(test_view.Find("lunarg_other.a", value));
+    EXPECT_FALSE(test_view.Find("lunarg_tests.a", value));
+
+    const vl::SettingsFileView missing_view(file, "lunarg_missing.");
+    EXPECT_TRUE(missing_view.begin() == missing_view.end());
+
+    const vl::SettingsFileView empty_view;
+    EXPECT_TRUE(empty_view.begin() == empty_view.end());
+    EXPECT_FALSE(empty_view.Find("lunarg_test.a", value));
+
+    // A file modified in place is parsed again, the values of the previous parse remain valid
+    {
+        std::ofstream text_file(pFilename, std::ios::trunc);
+        text_file << "lunarg_test.a = 10\n";
+    }
+    std::shared_ptr<const vl::SettingsFile> modified_file = vl::SettingsFile::Acquire(pFilename, *environment);
+    EXPECT_NE(file, modified_file);
+    EXPECT_TRUE(vl::SettingsFileView(modified_file, "lunarg_test.").Find("lunarg_test.a", value));
+    EXPECT_EQ("10", value);
+    EXPECT_TRUE(test_view.Find("lunarg_test.a", value));
+    EXPECT_EQ("1", value);
+
+    std::remove(pFilename);
+}
+
+// The scanners must accept the same strings as the regular expressions they replaced
+TEST(test_layer_settings_util, is_scanners_match_regex) {
+    const std::regex FRAMESETS_REGEX("^([0-9]+([-][0-9]+){0,2})(,([0-9]+([-][0-9]+){0,2}))*$");
+    const std::regex INTEGER_REGEX("^-?([0-9]*|0x[0-9|a-z|A-Z]*)$");
+    const std::regex FLOAT_REGEX("^-?[0-9]*([.][0-9]*f?)?$");
+
+    const std::string alphabet = "01-x,.f|a";
+
+    std::vector<std::string> inputs{""};
+    for (std::size_t begin = 0, length = 0; length < 5; ++length) {
+        const std::size_t end = inputs.size();
+        for (std::size_t i = begin; i < end; ++i) {
+            for (char c : alphabet) {
+                inputs.push_back(inputs[i] + c);
+            }
+        }
+        begin = end;
+    }
+
+    for (const std::string &input : inputs) {
+        EXPECT_EQ(std::regex_search(input, FRAMESETS_REGEX), vl::IsFrameSets(input)) << input;
+        EXPECT_EQ(std::regex_search(input, INTEGER_REGEX), vl::IsInteger(input)) << input;
+        EXPECT_EQ(std::regex_search(input, FLOAT_REGEX), vl::IsFloat(input)) << input;
+    }
+}
+
+TEST(test_layer_settings_util, is_scanners_large_input) {
+    std::string framesets;
+    while (framesets.size() < 8 * 1024 * 1024) {
+        framesets += "1-8-2,";
+    }
+    framesets += "76";
+
+    EXPECT_EQ(true, vl::IsFrameSets(framesets));
+    EXPECT_EQ(false, vl::IsFrameSets(framesets + ","));
+
+    const std::string digits(8 * 1024 * 1024, '7');
+    EXPECT_EQ(true, vl::IsInteger(digits));
+    EXPECT_EQ(true, vl::IsFloat(digits + ".5f"));
+}
+
 TEST(test_layer_settings_util, is_framesets) {
     EXPECT_EQ(true, vl::IsFrameSets("0"));
     EXPECT_EQ(true, vl::IsFrameSets("0-2"));
@@ -534,3 +916,352 @@ TEST(test_layer_settings_util, to_framesets) {
         EXPECT_EQ(1, framesets[3].step);
     }
 }
+
+// Frames below 'frame_count' selected by 'framesets', one frameset after the other
+static std::vector<bool> GetSelectedFrames(const std::vector<VkFrameset> &framesets, uint32_t frame_count) {
+    std::vector<bool> selected(frame_count, false);
+    for (const VkFrameset &frameset : framesets) {
+        for (uint64_t i = 0, frame = frameset.first; i < frameset.count && frame < frame_count; ++i, frame += frameset.step) {
+            selected[frame] = true;
+            if (frameset.step == 0) {
+                break;
+            }
+        }
+    }
+    return selected;
+}
+
+TEST(test_layer_settings_util, FramesetIndex) {
+    const std::vector<VkFrameset> framesets = vl::ToFrameSets("0,5-3,6-4,20-3-5,100000-10,100005-10,200000-4-1000");
+    const vl::FramesetIndex index(framesets.data(), framesets.size());
+
+    const std::vector<bool> selected = GetSelectedFrames(framesets, 210000);
+    for (uint32_t frame = 0; frame < selected.size(); ++frame) {
+        ASSERT_EQ(selected[frame], index.Contains(frame)) << "frame " << frame;
+    }
+    EXPECT_FALSE(index.Contains(0xFFFFFFFF));
+
+    const vl::FramesetIndex empty;
+    EXPECT_FALSE(empty.Contains(0));
+}
+
+TEST(test_layer_settings_util, FramesetIndex_Random) {
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<uint32_t> first(0, 200000);
+    std::uniform_int_distribution<uint32_t> count(0, 100);
+    std::uniform_int_distribution<uint32_t> step(0, 4);
+
+    std::vector<VkFrameset> framesets(1000);
+    for (VkFrameset &frameset : framesets) {
+        frameset = VkFrameset{first(generator), count(generator), step(generator)};
+    }
+    framesets.push_back(VkFrameset{0xFFFFFFF0, 0xFFFFFFFF, 1});
+
+    const vl::FramesetIndex index(framesets.data(), framesets.size());
+
+    const std::vector<bool> selected = GetSelectedFrames(framesets, 201000);
+    for (uint32_t frame = 0; frame < selected.size(); ++frame) {
+        ASSERT_EQ(selected[frame], index.Contains(frame)) << "frame " << frame;
+    }
+    EXPECT_TRUE(index.Contains(0xFFFFFFFF));
+}
+
+TEST(test_layer_settings_util, FramesetIndex_Strided) {
+    // Overlapping and adjacent framesets of the same step and residue past the bitmap, with a few distinct steps
+    std::mt19937 generator(2);
+    std::uniform_int_distribution<uint32_t> first(vl::FramesetIndex::MAX_BITMAP_FRAME_COUNT, 100000);
+    std::uniform_int_distribution<uint32_t> count(1, 500);
+    std::uniform_int_distribution<uint32_t> step(2, 9);
+
+    std::vector<VkFrameset> framesets(2000);
+    for (VkFrameset &frameset : framesets) {
+        frameset = VkFrameset{first(generator), count(generator), step(generator)};
+    }
+    framesets.push_back(VkFrameset{0xFFFF0000, 16, 0x1000});
+
+    const vl::FramesetIndex index(framesets.data(), framesets.size());
+
+    const std::vector<bool> selected = GetSelectedFrames(framesets, 105000);
+    for (uint32_t frame = vl::FramesetIndex::MAX_BITMAP_FRAME_COUNT; frame < selected.size(); ++frame) {
+        ASSERT_EQ(selected[frame], index.Contains(frame)) << "frame " << frame;
+    }
+    EXPECT_TRUE(index.Contains(0xFFFF0000));
+    EXPECT_TRUE(index.Contains(0xFFFFF000));
+    EXPECT_FALSE(index.Contains(0xFFFFF001));
+}
+
+TEST(test_layer_settings_util, StringSet) {
+    const char *values[] = {"0x4dae5635", "VUID-vkCmdDraw-None-02699", "", "0x4dae5635", nullptr, "UNASSIGNED-CoreValidation"};
+    const vl::StringSet set(values, sizeof(values) / sizeof(values[0]));
+
+    EXPECT_TRUE(set.Contains("0x4dae5635"));
+    EXPECT_TRUE(set.Contains("VUID-vkCmdDraw-None-02699"));
+    EXPECT_TRUE(set.Contains("UNASSIGNED-CoreValidation"));
+    EXPECT_TRUE(set.Contains(""));
+    EXPECT_FALSE(set.Contains("0x4dae563"));
+    EXPECT_FALSE(set.Contains("0x4DAE5635"));
+    EXPECT_FALSE(set.Contains("VUID-vkCmdDraw-None-02699 "));
+
+    const vl::StringSet empty(values, 0);
+    EXPECT_FALSE(empty.Contains(""));
+    EXPECT_FALSE(empty.Contains("0x4dae5635"));
+}
+
+TEST(test_layer_settings_util, StringSet_Large) {
+    std::vector<std::string> strings;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        strings.push_back(vl::Format("0x%08x", i * 2654435761u));
+    }
+
+    std::vector<const char *> values;
+    for (const std::string &string : strings) {
+        values.push_back(string.c_str());
+    }
+
+    const vl::StringSet set(values.data(), values.size());
+
+    for (uint32_t i = 0; i < 10000; ++i) {
+        ASSERT_TRUE(set.Contains(strings[i])) << strings[i];
+        ASSERT_FALSE(set.Contains(vl::Format("0x%08x", i * 2654435761u + 1))) << i;
+    }
+}
+
+TEST(test_layer_settings_util, Arena) {
+    vl::Arena arena;
+    EXPECT_EQ(0u, arena.GetSize());
+
+    const std::string_view copy = arena.CopyString("lunarg_test.my_setting");
+    EXPECT_EQ("lunarg_test.my_setting", copy);
+    EXPECT_EQ('\0', copy.data()[copy.size()]);
+    EXPECT_EQ('\0', arena.CopyString("").data()[0]);
+    EXPECT_EQ(vl::Arena::MIN_BLOCK_SIZE, arena.GetSize());
+
+    // Allocations are aligned and don't overlap
+    char *previous = static_cast<char *>(arena.Allocate(1, 1));
+    for (std::size_t alignment = 1; alignment <= alignof(std::max_align_t); alignment *= 2) {
+        char *data = static_cast<char *>(arena.Allocate(3, alignment));
+        EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(data) % alignment);
+        EXPECT_TRUE(data > previous || data + 3 <= previous);
+        previous = data;
+    }
+
+    // Containers grow in the arena, the memory is freed with the arena
+    vl::ArenaVector<int> values(arena);
+    for (int i = 0; i < 10000; ++i) {
+        values.push_back(i);
+    }
+    EXPECT_EQ(9999, values.back());
+
+    vl::ArenaMap<std::string_view, std::string_view> map(arena);
+    map.emplace(arena.CopyString("key"), arena.CopyString("value"));
+    EXPECT_EQ("value", map.find("key")->second);
+
+    // Large allocations have their own block
+    const std::size_t size = arena.GetSize();
+    arena.Allocate(vl::Arena::MAX_BLOCK_SIZE * 2, 1);
+    EXPECT_LE(size + vl::Arena::MAX_BLOCK_SIZE * 2, arena.GetSize());
+    EXPECT_LE(arena.GetUsedSize(), arena.GetSize());
+}
+
+TEST(test_layer_settings_util, RcuPointer) {
+    struct Counted {
+        explicit Counted(int &live_count) : live_count(live_count) { ++this->live_count; }
+        ~Counted() { --this->live_count; }
+        int &live_count;
+    };
+
+    int live_count = 0;
+    {
+        vl::RcuPointer<Counted> pointer;
+        pointer.Publish(std::make_unique<Counted>(live_count));
+        EXPECT_EQ(1, live_count);
+
+        {
+            // The object loaded by a reader outlives the next publications until the reader leaves its read section
+            vl::RcuReadGuard guard;
+            const Counted *loaded = pointer.Load();
+
+            pointer.Publish(std::make_unique<Counted>(live_count));
+            pointer.Publish(std::make_unique<Counted>(live_count));
+            EXPECT_EQ(3, live_count);
+            EXPECT_EQ(&live_count, &loaded->live_count);
+
+            {
+                vl::RcuReadGuard nested_guard;
+                EXPECT_NE(loaded, pointer.Load());
+            }
+            pointer.Publish(std::make_unique<Counted>(live_count));
+            EXPECT_EQ(4, live_count);
+        }
+
+        // No reader: the retired objects are deleted by the next publication
+        pointer.Publish(std::make_unique<Counted>(live_count));
+        EXPECT_EQ(1, live_count);
+
+        // A publication waits for the readers of another thread to delete the previous object
+        std::atomic<bool> reading{false};
+        std::thread reader([&reading]() {
+            vl::RcuReadGuard guard;
+            reading.store(true);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        });
+        while (!reading.load()) {
+            std::this_thread::yield();
+        }
+        pointer.Publish(std::make_unique<Counted>(live_count));
+        EXPECT_EQ(1, live_count);
+        reader.join();
+    }
+    EXPECT_EQ(0, live_count);
+}
+
+static std::mutex log_test_mutex;
+static std::vector<std::pair<std::string, std::string>> log_test_messages;
+
+static void *LogTestCallback(const char *pSettingName, const char *pMessage) {
+    std::lock_guard<std::mutex> lock(log_test_mutex);
+    log_test_messages.emplace_back(pSettingName, pMessage);
+    return nullptr;
+}
+
+TEST(test_layer_settings_util, SettingsLog) {
+    vl::SettingsLog &log = vl::SettingsLog::Get();
+    const uint64_t source = log.NewSource();
+
+    // The repetitions of a message logged by many threads are counted, not delivered
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&log, source]() {
+            for (int j = 0; j < 100; ++j) {
+                log.Push(source, LogTestCallback, "my_setting", "The data provided (x) at index 0 is not an integer.");
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    log.Push(source, LogTestCallback, "my_other_setting", "The data provided (y) at index 1 is not an integer.");
+
+    log.Flush();
+    {
+        std::lock_guard<std::mutex> lock(log_test_mutex);
+        ASSERT_EQ(3, log_test_messages.size());
+        EXPECT_EQ("my_setting", log_test_messages[0].first);
+        EXPECT_EQ("The data provided (x) at index 0 is not an integer.", log_test_messages[0].second);
+        EXPECT_EQ("my_other_setting", log_test_messages[1].first);
+        EXPECT_EQ("my_setting", log_test_messages[2].first);
+        EXPECT_EQ("The data provided (x) at index 0 is not an integer. (repeated 399 more times)", log_test_messages[2].second);
+        log_test_messages.clear();
+    }
+
+    // Only the new repetitions are reported, and another source delivers the message again
+    log.Push(source, LogTestCallback, "my_setting", "The data provided (x) at index 0 is not an integer.");
+    log.Push(log.NewSource(), LogTestCallback, "my_setting", "The data provided (x) at index 0 is not an integer.");
+
+    const std::string long_message(1000, 'x');
+    log.Push(source, LogTestCallback, "my_setting", long_message.c_str());
+
+    log.Flush();
+    {
+        std::lock_guard<std::mutex> lock(log_test_mutex);
+        ASSERT_EQ(3, log_test_messages.size());
+        EXPECT_EQ("The data provided (x) at index 0 is not an integer.", log_test_messages[0].second);
+        EXPECT_EQ(std::string(vl::SettingsLog::MESSAGE_SIZE - 1, 'x'), log_test_messages[1].second);
+        EXPECT_EQ("The data provided (x) at index 0 is not an integer. (repeated 1 more times)", log_test_messages[2].second);
+        log_test_messages.clear();
+    }
+
+    // The setting names are not truncated
+    const std::string long_setting_name(200, 's');
+    log.Push(source, LogTestCallback, long_setting_name.c_str(), "The data provided (z) at index 2 is not an integer.");
+
+    log.Flush();
+    {
+        std::lock_guard<std::mutex> lock(log_test_mutex);
+        ASSERT_EQ(1, log_test_messages.size());
+        EXPECT_EQ(long_setting_name, log_test_messages[0].first);
+        log_test_messages.clear();
+    }
+}
+
+TEST(test_layer_settings_util, SettingsLog_ReleaseSource) {
+    vl::SettingsLog &log = vl::SettingsLog::Get();
+
+    // The repetitions of a released source are reported and its entries of the repetition table freed, more sources than the
+    // table holds are released
+    for (std::size_t i = 0; i < vl::SettingsLog::REPETITION_CAPACITY * 2; ++i) {
+        const uint64_t source = log.NewSource();
+        const std::string message = "The data provided (" + std::to_string(i) + ") at index 0 is not an integer.";
+        log.Push(source, LogTestCallback, "my_setting", message.c_str());
+        log.Push(source, LogTestCallback, "my_setting", message.c_str());
+        log.ReleaseSource(source);
+
+        if (i % (vl::SettingsLog::RING_CAPACITY / 2) == 0) {
+            log.Flush();
+        }
+    }
+
+    log.Flush();
+    {
+        std::lock_guard<std::mutex> lock(log_test_mutex);
+        ASSERT_EQ(vl::SettingsLog::REPETITION_CAPACITY * 4, log_test_messages.size());
+        EXPECT_EQ("The data provided (0) at index 0 is not an integer.", log_test_messages[0].second);
+        EXPECT_EQ("The data provided (0) at index 0 is not an integer. (repeated 1 more times)", log_test_messages[1].second);
+        log_test_messages.clear();
+    }
+
+    // The repetitions of the messages of a new source are still counted
+    const uint64_t source = log.NewSource();
+    for (int i = 0; i < 16; ++i) {
+        const std::string message = "The data provided (" + std::to_string(i) + ") at index 1 is not an integer.";
+        for (int j = 0; j < 3; ++j) {
+            log.Push(source, LogTestCallback, "my_setting", message.c_str());
+        }
+    }
+    log.ReleaseSource(source);
+
+    log.Flush();
+    {
+        std::lock_guard<std::mutex> lock(log_test_mutex);
+        ASSERT_EQ(32, log_test_messages.size());
+        for (std::size_t i = 16; i < log_test_messages.size(); ++i) {
+            EXPECT_NE(std::string::npos, log_test_messages[i].second.find(" (repeated 2 more times)"));
+        }
+        log_test_messages.clear();
+    }
+}
+
+static std::size_t WaitLogTestMessages(std::size_t count) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(log_test_mutex);
+            if (log_test_messages.size() >= count || std::chrono::steady_clock::now() > deadline) {
+                return log_test_messages.size();
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+TEST(test_layer_settings_util, SettingsLog_Idle) {
+    vl::SettingsLog &log = vl::SettingsLog::Get();
+    const uint64_t source = log.NewSource();
+
+    // Delivered without Flush, then the drain thread sleeps without deadline
+    log.Push(source, LogTestCallback, "my_setting", "The data provided (x) at index 3 is not an integer.");
+    ASSERT_EQ(1, WaitLogTestMessages(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // A repetition wakes the drain thread up, which reports it after the report interval
+    log.Push(source, LogTestCallback, "my_setting", "The data provided (x) at index 3 is not an integer.");
+    ASSERT_EQ(2, WaitLogTestMessages(2));
+    {
+        std::lock_guard<std::mutex> lock(log_test_mutex);
+        EXPECT_EQ("The data provided (x) at index 3 is not an integer. (repeated 1 more times)", log_test_messages[1].second);
+        log_test_messages.clear();
+    }
+
+    log.ReleaseSource(source);
+    log.Flush();
+}